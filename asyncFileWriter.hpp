@@ -0,0 +1,175 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Writes files on a background thread so slow disks don't stall the editor
+ *
+ * Every write goes to a temporary file next to the target which is flushed to disk and then renamed over the target, so
+ * the file on disk is always either the old or the new version. Requests that arrive while a write is in progress are
+ * coalesced, only the newest one is written.
+ */
+class AsyncFileWriter {
+private:
+	struct Job {
+		unsigned long generation;
+		std::string filename;
+		std::function<std::string()> serialize;
+	};
+
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	bool hasPending{false};
+	bool stopping{false};
+	Job pending;
+
+	unsigned long requestedGeneration{0};
+	unsigned long completedGeneration{0};
+	bool lastSucceeded{true};
+
+	// Last so everything run() reads is initialized before the thread starts
+	std::thread worker;
+
+	/**
+	 * @brief Write contents to filename atomically
+	 */
+	static bool writeAtomically(const std::string& filename, const std::string& contents) {
+		std::string temporaryName = filename + ".tmp";
+
+#ifndef _WIN32
+		int descriptor = ::open(temporaryName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (descriptor < 0) {
+			return false;
+		}
+
+		const char* data = contents.data();
+		size_t remaining = contents.size();
+
+		while (remaining > 0) {
+			ssize_t written = ::write(descriptor, data, remaining);
+			if (written < 0) {
+				close(descriptor);
+				remove(temporaryName.c_str());
+				return false;
+			}
+			data += written;
+			remaining -= written;
+		}
+
+		if (fsync(descriptor) != 0 || close(descriptor) != 0) {
+			remove(temporaryName.c_str());
+			return false;
+		}
+#else
+		FILE* file = fopen(temporaryName.c_str(), "wb");
+		if (file == nullptr) {
+			return false;
+		}
+
+		bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+
+		if (fclose(file) != 0 || !written) {
+			remove(temporaryName.c_str());
+			return false;
+		}
+
+		// rename doesn't replace existing files on windows
+		remove(filename.c_str());
+#endif
+
+		if (rename(temporaryName.c_str(), filename.c_str()) != 0) {
+			remove(temporaryName.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			condition.wait(lock, [this]() { return hasPending || stopping; });
+
+			if (!hasPending) {
+				return;
+			}
+
+			Job job = std::move(pending);
+			hasPending = false;
+
+			lock.unlock();
+			bool succeeded = writeAtomically(job.filename, job.serialize());
+			lock.lock();
+
+			completedGeneration = job.generation;
+			lastSucceeded = succeeded;
+		}
+	}
+
+public:
+	AsyncFileWriter() : worker(&AsyncFileWriter::run, this) {}
+
+	AsyncFileWriter(const AsyncFileWriter&) = delete;
+	AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+	/**
+	 * @brief Queue a write, replacing any write that hasn't started yet
+	 *
+	 * @param filename The file to write
+	 * @param serialize Produces the contents of the file, run on the writer thread. It should own a snapshot of
+	 * whatever it serializes
+	 * @return unsigned long Generation of this write, compare with getCompletedGeneration()
+	 */
+	unsigned long write(std::string filename, std::function<std::string()> serialize) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		pending = {++requestedGeneration, std::move(filename), std::move(serialize)};
+		hasPending = true;
+
+		condition.notify_one();
+
+		return requestedGeneration;
+	}
+
+	/**
+	 * @brief Generation of the newest write that has finished, skipped writes count as finished along with the write
+	 * that replaced them
+	 */
+	unsigned long getCompletedGeneration() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return completedGeneration;
+	}
+
+	/**
+	 * @brief Whether the last finished write made it to disk
+	 */
+	bool getLastSucceeded() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return lastSucceeded;
+	}
+
+	/**
+	 * @brief Finishes any queued write before returning
+	 */
+	~AsyncFileWriter() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		condition.notify_one();
+		worker.join();
+	}
+};
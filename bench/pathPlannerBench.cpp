@@ -0,0 +1,179 @@
+// Micro and macro benchmarks for the path math, prints the results as JSON so runs can be compared over time
+//
+// Usage: path_planner_bench [--max-segments N] [--min-time-ms N]
+
+#include "bezierSegment.hpp"
+#include "driveSimulator.hpp"
+#include "linearInterpolator.hpp"
+#include "polynomialExpression.hpp"
+#include "sinusoidalVelocityProfile.hpp"
+#include "velocityPlanner.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+	std::string name;
+	int segments;
+	long iterations;
+	double nsPerOp;
+	double totalMs;
+};
+
+// Written to after every operation so the compiler can't drop the work being timed
+volatile double sink = 0.0;
+
+double minTimeMs = 200.0;
+
+/**
+ * @brief Run an operation repeatedly until it has run for at least minTimeMs, doubling the batch size each round
+ */
+BenchResult run(const std::string& name, int segments, const std::function<void()>& operation) {
+	long iterations = 0;
+	long batch = 1;
+	std::chrono::duration<double, std::milli> elapsed{0.0};
+
+	while (elapsed.count() < minTimeMs) {
+		auto start = std::chrono::steady_clock::now();
+		for (long i = 0; i < batch; i++) {
+			operation();
+		}
+		elapsed += std::chrono::steady_clock::now() - start;
+		iterations += batch;
+		batch *= 2;
+	}
+
+	BenchResult result{name, segments, iterations, elapsed.count() * 1.0e6 / (double) iterations, elapsed.count()};
+
+	fprintf(stderr, "%-40s %6d segments %12.1f ns/op (%ld iterations)\n", name.c_str(), segments, result.nsPerOp, iterations);
+
+	return result;
+}
+
+/**
+ * @brief A winding path made of n segments, every segment is about 24 inches long and alternates turning left and right
+ */
+std::vector<PathPlanner::BezierSegment> syntheticPath(int n) {
+	std::vector<PathPlanner::BezierSegment> segments;
+	segments.reserve(n);
+
+	for (int i = 0; i < n; i++) {
+		double x = 24.0 * i;
+		double bend = (i % 2 == 0) ? 8.0 : -8.0;
+		segments.emplace_back(
+				PathPlanner::Point(x * 1_in, 0_in),
+				PathPlanner::Point((x + 8.0) * 1_in, bend * 1_in),
+				PathPlanner::Point((x + 16.0) * 1_in, -bend * 1_in),
+				PathPlanner::Point((x + 24.0) * 1_in, 0_in));
+	}
+
+	return segments;
+}
+
+int main(int argc, char** argv) {
+	int maxSegments = 10000;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--max-segments") == 0 && i + 1 < argc) {
+			maxSegments = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+			minTimeMs = atof(argv[++i]);
+		} else {
+			fprintf(stderr, "Usage: %s [--max-segments N] [--min-time-ms N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<BenchResult> results;
+
+	PathPlanner::PolynomialExpression polynomial({1.0, -3.0, 3.0, 0.5});
+	double x = 0.0;
+	results.emplace_back(run("PolynomialExpression::evaluate", 0, [&]() {
+		sink = sink + polynomial.evaluate(x);
+		x = x > 1.0 ? 0.0 : x + 0.001;
+	}));
+
+	PathPlanner::Point a(0_in, 0_in), b(10_in, 20_in), c(30_in, -5_in), d(40_in, 10_in);
+	results.emplace_back(run("BezierSegment::BezierSegment", 1, [&]() {
+		PathPlanner::BezierSegment segment(a, b, c, d);
+		sink = sink + segment.getDistance().getValue();
+	}));
+
+	PathPlanner::BezierSegment segment(a, b, c, d);
+	double t = 0.0;
+	results.emplace_back(run("BezierSegment::getCurvature", 1, [&]() {
+		sink = sink + segment.getCurvature(t).getValue();
+		t = t > 1.0 ? 0.0 : t + 0.001;
+	}));
+
+	double distance = 0.0;
+	results.emplace_back(run("BezierSegment::getTByLength", 1, [&]() {
+		sink = sink + segment.getTByLength(distance);
+		distance = distance > segment.getDistance().getValue() ? 0.0 : distance + 0.0037;
+	}));
+
+	PathPlanner::LinearInterpolator interpolator;
+	for (int i = 0; i <= 100; i++) {
+		interpolator.add(i * 0.01 * i, i * 0.01);
+	}
+	double key = 0.0;
+	results.emplace_back(run("LinearInterpolator::get", 0, [&]() {
+		sink = sink + interpolator.get(key);
+		key = key > 100.0 ? 0.0 : key + 0.37;
+	}));
+
+	results.emplace_back(run("SinusoidalVelocityProfile::calculate", 0, [&]() {
+		Pronounce::SinusoidalVelocityProfile profile(48_in, 60_in/second, 100_in/second/second, 0.0);
+		profile.calculate(100);
+		sink = sink + profile.getDuration().getValue();
+	}));
+
+	PathPlanner::VelocityPlanner planner({60_in/second, 100_in/second/second, 8_in});
+
+	PathPlanner::PlannerConstraints adaptiveConstraints{60_in/second, 100_in/second/second, 8_in};
+	adaptiveConstraints.maxTimeError = 0.005_s;
+	PathPlanner::VelocityPlanner adaptivePlanner(adaptiveConstraints);
+
+	PathPlanner::PlannerConstraints reachabilityConstraints{60_in/second, 100_in/second/second, 8_in};
+	reachabilityConstraints.method = PathPlanner::PlannerMethod::Reachability;
+	PathPlanner::VelocityPlanner reachabilityPlanner(reachabilityConstraints);
+
+	PathPlanner::DriveSimulator simulator;
+
+	for (int n = 1; n <= maxSegments; n *= 10) {
+		std::vector<PathPlanner::BezierSegment> path = syntheticPath(n);
+		std::vector<bool> inverted(n, false);
+
+		results.emplace_back(run("VelocityPlanner::calculate", n, [&]() {
+			sink = sink + planner.calculate(path, inverted).duration.getValue();
+		}));
+
+		results.emplace_back(run("VelocityPlanner::calculate adaptive", n, [&]() {
+			sink = sink + adaptivePlanner.calculate(path, inverted).duration.getValue();
+		}));
+
+		results.emplace_back(run("VelocityPlanner::calculate reachability", n, [&]() {
+			sink = sink + reachabilityPlanner.calculate(path, inverted).duration.getValue();
+		}));
+
+		PathPlanner::PlannedPath plannedPath = planner.calculate(path, inverted);
+
+		results.emplace_back(run("DriveSimulator::simulate", n, [&]() {
+			sink = sink + simulator.simulate(plannedPath).finalError.getValue();
+		}));
+	}
+
+	printf("{\n\t\"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		printf("\t\t{\"name\": \"%s\", \"segments\": %d, \"iterations\": %ld, \"ns_per_op\": %.3f, \"total_ms\": %.3f}%s\n",
+			   results[i].name.c_str(), results[i].segments, results[i].iterations, results[i].nsPerOp, results[i].totalMs,
+			   i + 1 < results.size() ? "," : "");
+	}
+	printf("\t]\n}\n");
+
+	return 0;
+}
@@ -1,13 +1,18 @@
 #pragma once
 
-#include "polynomialExpression.hpp"
-#include "vector.hpp"
+#include "vec2.hpp"
+#include "chebyshevApproximation.hpp"
 #include "linearInterpolator.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace PathPlanner {
 	class BezierSegment {
 	private:
-		PolynomialExpression x, y, dx, dy, ddx, ddy;
+		// Power basis coefficients of the position and its derivatives, x and y are evaluated together
+		Vec2 position[4];
+		Vec2 velocity[3];
+		Vec2 acceleration[2];
 
 		Point a;
 		Point b;
@@ -15,10 +20,29 @@ namespace PathPlanner {
 		Point d;
 
 		QLength length;
+
+		// Reference table of distance and t at evenly spaced t, t between entries is linear in distance
 		LinearInterpolator distanceToT;
 
+		// The table fit with a polynomial so finding t doesn't search the table, segments the fit can't follow closely
+		// enough use the table
+		ChebyshevApproximation distanceToTFit;
+		bool fitted;
+
+		// Largest difference in t from the table the fit can have before the table is used instead, far under the 1e-4 a
+		// position needs so planned paths and the goldens pinning them stay the same
+		static constexpr double maxFitError = 5.0e-6;
+
+		// Points checked against the table per table step, the table's kinks are at the entries so the error peaks near
+		// them and a few points between catch the fit drifting off
+		static constexpr int fitChecksPerStep = 4;
+
 		bool reversed;
 
+		double getSpeed(double t) const {
+			return getVelocity(t).getLength();
+		}
+
 	public:
 		BezierSegment(Point a, Point b, Point c, Point d, bool reversed = false, int granularity = 100) {
 			this->a = a;
@@ -28,30 +52,63 @@ namespace PathPlanner {
 
 			this->reversed = reversed;
 
-			x = PolynomialExpression({
-											 a.getX().getValue(),
-											 3.0*b.getX().getValue() - 3.0*a.getX().getValue(),
-											 3.0*c.getX().getValue() - 6.0*b.getX().getValue() + 3.0*a.getX().getValue(),
-											 d.getX().getValue() - 3.0*c.getX().getValue() + 3.0*b.getX().getValue() - a.getX().getValue()}
-			);
-			y = PolynomialExpression({
-											 a.getY().getValue(),
-											 3.0*b.getY().getValue() - 3.0*a.getY().getValue(),
-											 3.0*c.getY().getValue() - 6.0*b.getY().getValue() + 3.0*a.getY().getValue(),
-											 d.getY().getValue() - 3.0*c.getY().getValue() + 3.0*b.getY().getValue() - a.getY().getValue()}
-			);
-
-			dx = x.getDerivative();
-			dy = y.getDerivative();
-
-			ddx = dx.getDerivative();
-			ddy = dy.getDerivative();
+			Vec2 a0(a), b0(b), c0(c), d0(d);
+
+			position[0] = a0;
+			position[1] = (b0 - a0) * 3.0;
+			position[2] = (c0 - b0 * 2.0 + a0) * 3.0;
+			position[3] = d0 - c0 * 3.0 + b0 * 3.0 - a0;
+
+			for (int i = 0; i < 3; i++) {
+				velocity[i] = position[i + 1] * (i + 1.0);
+			}
+
+			for (int i = 0; i < 2; i++) {
+				acceleration[i] = velocity[i + 1] * (i + 1.0);
+			}
+
+			granularity = std::max(granularity, 1);
+
+			// Distance at evenly spaced t, each step adds the trapezoid between the speeds at its ends
+			double step = 1.0 / (double) granularity;
+			double lastSpeed = getSpeed(0.0);
+
+			std::vector<double> distances = {0.0};
 
 			length = 0.0;
+			distanceToT.add(0.0, 0.0);
+
+			for (int i = 1; i <= granularity; i++) {
+				double speed = getSpeed(i * step);
+
+				length += (lastSpeed + speed) * 0.5 * step;
+				distanceToT.add(length.getValue(), i * step);
+				distances.emplace_back(length.getValue());
+
+				lastSpeed = speed;
+			}
+
+			// Largest difference between the fit and the table, checked at every entry and evenly between them
+			auto getMaxFitError = [&]() {
+				double maxError = 0.0;
 
-			for (int t = 0.0; t <= granularity; t += 1) {
-				length += sqrt(pow(dx.evaluate((double)t/(double) granularity), 2) + pow(dy.evaluate((double)t/(double) granularity), 2)) / (double) granularity;
-				distanceToT.add(length.getValue(), (double)t/(double) granularity);
+				for (int i = 0; i < granularity; i++) {
+					for (int check = 0; check < fitChecksPerStep; check++) {
+						double fraction = (double) check / fitChecksPerStep;
+						double distance = distances[i] + (distances[i + 1] - distances[i]) * fraction;
+
+						maxError = std::max(maxError, fabs(distanceToTFit.evaluate(distance) - (i + fraction) * step));
+					}
+				}
+
+				return std::max(maxError, fabs(distanceToTFit.evaluate(length.getValue()) - 1.0));
+			};
+
+			fitted = false;
+
+			for (int degree = 8; degree <= ChebyshevApproximation::maxDegree && !fitted && length.getValue() > 0.0; degree *= 2) {
+				distanceToTFit.fit([&](double distance) { return distanceToT.get(distance); }, 0.0, length.getValue(), degree);
+				fitted = getMaxFitError() <= maxFitError;
 			}
 		}
 
@@ -60,11 +117,51 @@ namespace PathPlanner {
 		}
 
 		double getTByLength(QLength distance) {
-			return distanceToT.get(distance.getValue());
+			double t = fitted ? distanceToTFit.evaluate(fabs(distance.getValue())) : distanceToT.get(fabs(distance.getValue()));
+
+			return std::clamp(t, 0.0, 1.0);
 		}
 
-		QCurvature getCurvature(double t) {
-			return -(dx.evaluate(t)*ddy.evaluate(t) - ddx.evaluate(t)*dy.evaluate(t))/pow(Vector(Point(dx.evaluate(t), dy.evaluate(t))).getMagnitude().getValue(), 3);
+		/**
+		 * @brief t from the reference table even where the fit is used, for checking the fit against
+		 */
+		double getReferenceTByLength(QLength distance) {
+			return distanceToT.get(fabs(distance.getValue()));
+		}
+
+		/**
+		 * @brief Whether getTByLength uses the fit, false for segments that stop inside them
+		 */
+		bool isFitted() const {
+			return fitted;
+		}
+
+		/**
+		 * @brief Position at t in meters
+		 */
+		Vec2 getPosition(double t) const {
+			return ((position[3] * t + position[2]) * t + position[1]) * t + position[0];
+		}
+
+		/**
+		 * @brief Derivative of the position by t in meters
+		 */
+		Vec2 getVelocity(double t) const {
+			return (velocity[2] * t + velocity[1]) * t + velocity[0];
+		}
+
+		/**
+		 * @brief Second derivative of the position by t in meters
+		 */
+		Vec2 getAcceleration(double t) const {
+			return acceleration[1] * t + acceleration[0];
+		}
+
+		QCurvature getCurvature(double t) const {
+			Vec2 first = getVelocity(t);
+			double speed = first.getLength();
+
+			return -first.cross(getAcceleration(t)) / (speed * speed * speed);
 		}
 
 		QCurvature getMaxCurvature(int granularity = 20) {
@@ -78,12 +175,20 @@ namespace PathPlanner {
 			return maxCurvature;
 		}
 
-		Angle getAngle(double t) {
-			return -atan2(dy.evaluate(t), dx.evaluate(t)) * radian + 90_deg;
+		Angle getAngle(double t) const {
+			Vec2 first = getVelocity(t);
+
+			// A handle on top of its end point leaves the curve without a velocity there, it leaves along the second
+			// derivative instead, backwards at the far end
+			if (first.getLength() == 0.0) {
+				first = getAcceleration(t) * (t < 0.5 ? 1.0 : -1.0);
+			}
+
+			return -atan2(first.y, first.x) * radian + 90_deg;
 		}
 
-		Point evaluate(double t) {
-			return {x.evaluate(t), y.evaluate(t)};
+		Point evaluate(double t) const {
+			return getPosition(t).toPoint();
 		}
 
 		double getMaxSpeedMultiplier(QLength trackWidth, int granularity = 100) {
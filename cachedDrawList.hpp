@@ -0,0 +1,104 @@
+#pragma once
+
+#include "imgui/imgui.h"
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Holds the tessellated vertices and indices of some draw calls so they can be resubmitted every frame without
+ * ImGui tessellating the shapes again
+ *
+ * The cache is keyed by a list of floats (control points, window position...) and is rebuilt whenever the key changes.
+ * Copies of a cache start empty, so the history snapshots of a path don't carry vertex data around.
+ */
+class CachedDrawList {
+private:
+	std::vector<ImDrawVert> vertices;
+	std::vector<ImDrawIdx> indices;
+
+	std::vector<float> key;
+	ImVec2 whitePixel;
+	bool valid{false};
+
+	/**
+	 * @brief Draw list that shapes are tessellated into before being copied into the cache, shared by every cache
+	 */
+	static ImDrawList& getScratch() {
+		static ImDrawList scratch(ImGui::GetDrawListSharedData());
+		return scratch;
+	}
+
+public:
+	CachedDrawList() = default;
+
+	CachedDrawList(const CachedDrawList&) {}
+
+	CachedDrawList& operator=(const CachedDrawList&) {
+		valid = false;
+		return *this;
+	}
+
+	/**
+	 * @brief Check if the cache was built with this key and the current font atlas
+	 *
+	 * @param newKey The values the cached shapes were generated from
+	 * @return bool Whether the cache can be submitted as is
+	 */
+	bool isValid(const std::vector<float>& newKey) const {
+		ImVec2 currentWhitePixel = ImGui::GetDrawListSharedData()->TexUvWhitePixel;
+
+		return valid && key == newKey && whitePixel.x == currentWhitePixel.x && whitePixel.y == currentWhitePixel.y;
+	}
+
+	/**
+	 * @brief Start rebuilding the cache, everything drawn to the returned list until end() is cached
+	 */
+	ImDrawList* begin() {
+		ImDrawList& scratch = getScratch();
+		scratch._ResetForNewFrame();
+		scratch.PushClipRectFullScreen();
+		return &scratch;
+	}
+
+	/**
+	 * @brief Copy what was drawn since begin() into the cache
+	 *
+	 * @param newKey The values the shapes were generated from
+	 */
+	void end(const std::vector<float>& newKey) {
+		ImDrawList& scratch = getScratch();
+		scratch.PopClipRect();
+
+		vertices.assign(scratch.VtxBuffer.Data, scratch.VtxBuffer.Data + scratch.VtxBuffer.Size);
+		indices.assign(scratch.IdxBuffer.Data, scratch.IdxBuffer.Data + scratch.IdxBuffer.Size);
+
+		key = newKey;
+		whitePixel = ImGui::GetDrawListSharedData()->TexUvWhitePixel;
+		valid = true;
+	}
+
+	/**
+	 * @brief Append the cached vertices to a draw list
+	 *
+	 * @param drawList The list to draw to, it has to use the font atlas texture like the foreground list does
+	 */
+	void submit(ImDrawList* drawList) const {
+		if (!valid || indices.empty()) {
+			return;
+		}
+
+		drawList->PrimReserve((int) indices.size(), (int) vertices.size());
+
+		ImDrawIdx offset = (ImDrawIdx) drawList->_VtxCurrentIdx;
+
+		memcpy(drawList->_VtxWritePtr, vertices.data(), vertices.size() * sizeof(ImDrawVert));
+
+		for (size_t i = 0; i < indices.size(); i++) {
+			drawList->_IdxWritePtr[i] = (ImDrawIdx) (indices[i] + offset);
+		}
+
+		drawList->_VtxWritePtr += vertices.size();
+		drawList->_IdxWritePtr += indices.size();
+		drawList->_VtxCurrentIdx += vertices.size();
+	}
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Approximation of a smooth function on an interval by a sum of Chebyshev polynomials
+	 *
+	 * Fit from the function at the Chebyshev nodes, which keeps the error close to the best polynomial of the same
+	 * degree. Evaluation is Clenshaw's recurrence over a fixed number of coefficients, so it takes the same time and has
+	 * no branches wherever it is evaluated.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class ChebyshevApproximation {
+	public:
+		static constexpr int maxDegree = 16;
+
+	private:
+		/**
+		 * @brief Coefficients of every polynomial, the ones past the fitted degree are 0
+		 */
+		std::array<double, maxDegree + 1> coefficients{};
+
+		double start{0.0};
+		double scale{0.0};
+
+	public:
+		/**
+		 * @brief Construct a new Chebyshev Approximation that is 0 everywhere
+		 */
+		ChebyshevApproximation() {}
+
+		/**
+		 * @brief Fit the approximation to a function
+		 *
+		 * @param function Function of a double to fit, called degree + 1 times
+		 * @param start Start of the interval
+		 * @param end End of the interval
+		 * @param degree Degree of the polynomial, at most maxDegree
+		 */
+		template<typename Function>
+		void fit(Function function, double start, double end, int degree) {
+			degree = std::clamp(degree, 0, maxDegree);
+			int nodes = degree + 1;
+
+			this->start = start;
+			this->scale = end > start ? 2.0 / (end - start) : 0.0;
+
+			coefficients.fill(0.0);
+
+			for (int k = 0; k < nodes; k++) {
+				double x = cos(M_PI * (k + 0.5) / nodes);
+				double value = function(start + (x + 1.0) * 0.5 * (end - start)) * 2.0 / nodes;
+
+				// The polynomials at the node from their recurrence instead of a cosine for each of them
+				double previous = 1.0;
+				double current = x;
+
+				coefficients[0] += value;
+
+				for (int j = 1; j < nodes; j++) {
+					coefficients[j] += value * current;
+
+					double next = 2.0 * x * current - previous;
+					previous = current;
+					current = next;
+				}
+			}
+
+			coefficients[0] *= 0.5;
+		}
+
+		/**
+		 * @brief Evaluate the approximation, values outside the interval are clamped to it
+		 */
+		double evaluate(double x) const {
+			double u = std::clamp((x - start) * scale - 1.0, -1.0, 1.0);
+
+			double b1 = 0.0;
+			double b2 = 0.0;
+
+			for (int j = maxDegree; j >= 1; j--) {
+				double b0 = 2.0 * u * b1 - b2 + coefficients[j];
+				b2 = b1;
+				b1 = b0;
+			}
+
+			return u * b1 - b2 + coefficients[0];
+		}
+	};
+} // namespace PathPlanner
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "velocityPlanner.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Checks whether robots running their paths at the same time ever touch
+	 *
+	 * Partner paths are sampled at a fixed time step and every sample's footprint is put in a spatial hash keyed by time
+	 * step and cell, so checking a path against every partner is a few lookups per time step. The circle around a
+	 * footprint finds the partners that could touch it, then the rectangles of the robots are checked against each other
+	 * so robots passing close by side by side aren't reported. Partners are hashed once when they change, only the path
+	 * being edited is sampled on every check. Robots sit at their first pose before they start and at their last pose
+	 * after they finish, they don't leave the field.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class ConflictChecker {
+	public:
+		/**
+		 * @brief The first time two robots touch
+		 */
+		struct Conflict {
+			bool found = false;
+
+			/**
+			 * @brief Seconds after the start of autonomous
+			 */
+			float time = 0.0;
+
+			/**
+			 * @brief Point between the touching parts of the robots in field inches
+			 */
+			float x = 0.0;
+			float y = 0.0;
+
+			/**
+			 * @brief Index of the partner in the order they were added
+			 */
+			int partner = -1;
+		};
+
+	private:
+		/**
+		 * @brief A robot at a time step, a rectangle facing along its path with the circle through its corners around it
+		 */
+		struct Footprint {
+			float x;
+			float y;
+			float dx;
+			float dy;
+			float halfLength;
+			float halfWidth;
+			float radius;
+			int partner;
+		};
+
+		// Time step for parked robots, they are in the way at every step after lastStep of their partner
+		static constexpr int32_t parkedStep = -1;
+
+		float timeStep;
+		float cellSize;
+
+		float maxRadius{0.0};
+
+		std::vector<Footprint> footprints;
+		std::vector<int32_t> lastSteps;
+
+		std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+
+		int32_t getCell(float value) const {
+			return (int32_t) std::floor(value / cellSize);
+		}
+
+		static uint64_t getKey(int32_t step, int32_t x, int32_t y) {
+			// The field is a few cells across, 16 bits per cell coordinate is plenty
+			return ((uint64_t) (uint32_t) step << 32) | ((uint64_t) (uint16_t) x << 16) | (uint16_t) y;
+		}
+
+		/**
+		 * @brief Footprint of a robot part of the way from a sample to the next, facing along the path
+		 */
+		static Footprint getFootprint(const PlannedPath& path, int sample, float fraction, float robotLength, float robotWidth) {
+			int samples = path.size();
+			int next = std::min(samples - 1, sample + 1);
+
+			const float* positionX = path.positionX.view(inch);
+			const float* positionY = path.positionY.view(inch);
+
+			float x = positionX[sample] + (positionX[next] - positionX[sample]) * fraction;
+			float y = positionY[sample] + (positionY[next] - positionY[sample]) * fraction;
+
+			int before = std::max(0, sample - 1);
+			int after = std::min(samples - 1, sample + 2);
+
+			float dx = positionX[after] - positionX[before];
+			float dy = positionY[after] - positionY[before];
+			float length = sqrt(dx * dx + dy * dy);
+
+			if (length > 0.0f) {
+				dx /= length;
+				dy /= length;
+			} else {
+				dx = 1.0f;
+				dy = 0.0f;
+			}
+
+			float radius = 0.5f * sqrt(robotLength * robotLength + robotWidth * robotWidth);
+
+			return {x, y, dx, dy, 0.5f * robotLength, 0.5f * robotWidth, radius, -1};
+		}
+
+		/**
+		 * @brief Half the extent of a footprint along an axis
+		 */
+		static float getProjectedRadius(const Footprint& footprint, float axisX, float axisY) {
+			float along = fabs(footprint.dx * axisX + footprint.dy * axisY);
+			float across = fabs(footprint.dx * axisY - footprint.dy * axisX);
+
+			return footprint.halfLength * along + footprint.halfWidth * across;
+		}
+
+		/**
+		 * @brief Whether two footprints overlap, two rectangles are apart exactly when one of their four edge directions
+		 * separates them
+		 */
+		static bool overlaps(const Footprint& a, const Footprint& b) {
+			float centerX = b.x - a.x;
+			float centerY = b.y - a.y;
+
+			for (const Footprint* footprint : {&a, &b}) {
+				for (auto [axisX, axisY] : {std::pair{footprint->dx, footprint->dy}, std::pair{-footprint->dy, footprint->dx}}) {
+					if (fabs(centerX * axisX + centerY * axisY) >= getProjectedRadius(a, axisX, axisY) + getProjectedRadius(b, axisX, axisY)) {
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Whether a point is inside a footprint
+		 */
+		static bool contains(const Footprint& footprint, float x, float y) {
+			float offsetX = x - footprint.x;
+			float offsetY = y - footprint.y;
+
+			return fabs(offsetX * footprint.dx + offsetY * footprint.dy) <= footprint.halfLength
+					&& fabs(offsetX * footprint.dy - offsetY * footprint.dx) <= footprint.halfWidth;
+		}
+
+		/**
+		 * @brief A point where two overlapping footprints meet, the middle of the corners of each inside the other or
+		 * the middle of the robots when they cross without a corner inside
+		 */
+		static std::pair<float, float> getContact(const Footprint& a, const Footprint& b) {
+			float sumX = 0.0;
+			float sumY = 0.0;
+			int count = 0;
+
+			for (auto [footprint, other] : {std::pair{&a, &b}, std::pair{&b, &a}}) {
+				for (float along : {-footprint->halfLength, footprint->halfLength}) {
+					for (float across : {-footprint->halfWidth, footprint->halfWidth}) {
+						float x = footprint->x + footprint->dx * along - footprint->dy * across;
+						float y = footprint->y + footprint->dy * along + footprint->dx * across;
+
+						if (contains(*other, x, y)) {
+							sumX += x;
+							sumY += y;
+							count++;
+						}
+					}
+				}
+			}
+
+			if (count == 0) {
+				return {0.5f * (a.x + b.x), 0.5f * (a.y + b.y)};
+			}
+
+			return {sumX / count, sumY / count};
+		}
+
+		/**
+		 * @brief Call a function with the footprint of a path at every time step from the first step to lastStep
+		 */
+		template<typename Function>
+		void forEachStep(const PlannedPath& path, float startTime, int32_t lastStep, float robotLength, float robotWidth, Function function) const {
+			int sample = 0;
+			int samples = path.size();
+			const float* times = path.time.view(second);
+
+			for (int32_t step = 0; step <= lastStep; step++) {
+				float time = step * timeStep - startTime;
+
+				// Time only goes forwards, so the sample is found by walking instead of searching
+				while (sample < samples - 2 && times[sample + 1] <= time) {
+					sample++;
+				}
+
+				float fraction = 0.0;
+
+				if (samples > 1) {
+					float sampleDuration = times[sample + 1] - times[sample];
+					fraction = sampleDuration > 0.0f ? std::clamp((time - times[sample]) / sampleDuration, 0.0f, 1.0f) : 1.0f;
+
+					if (time < 0.0f) {
+						fraction = 0.0f;
+					}
+				}
+
+				Footprint footprint = getFootprint(path, sample, fraction, robotLength, robotWidth);
+
+				if (!function(step, footprint)) {
+					return;
+				}
+			}
+		}
+
+		int32_t getLastStep(const PlannedPath& path, float startTime) const {
+			float endTime = startTime + (path.time.empty() ? 0.0f : path.time.back().Convert(second));
+
+			return std::max(0, (int32_t) ceil(endTime / timeStep));
+		}
+
+		void insert(int32_t step, const Footprint& footprint) {
+			uint32_t id = footprints.size();
+			footprints.push_back(footprint);
+
+			buckets[getKey(step, getCell(footprint.x), getCell(footprint.y))].emplace_back(id);
+		}
+
+		/**
+		 * @brief Find a partner footprint in a bucket that touches a footprint
+		 */
+		bool findTouching(int32_t step, int32_t bucketStep, const Footprint& footprint, Conflict& conflict) const {
+			float reach = footprint.radius + maxRadius;
+
+			for (int32_t cellX = getCell(footprint.x - reach); cellX <= getCell(footprint.x + reach); cellX++) {
+				for (int32_t cellY = getCell(footprint.y - reach); cellY <= getCell(footprint.y + reach); cellY++) {
+					auto bucket = buckets.find(getKey(bucketStep, cellX, cellY));
+
+					if (bucket == buckets.end()) {
+						continue;
+					}
+
+					for (auto &id : bucket->second) {
+						const Footprint& other = footprints[id];
+
+						if (bucketStep == parkedStep && lastSteps[other.partner] >= step) {
+							continue;
+						}
+
+						float dx = other.x - footprint.x;
+						float dy = other.y - footprint.y;
+						float touching = other.radius + footprint.radius;
+
+						// The circles are a cheap first check, most partners are nowhere near
+						if (dx * dx + dy * dy < touching * touching && overlaps(footprint, other)) {
+							conflict.found = true;
+							conflict.time = step * timeStep;
+							conflict.partner = other.partner;
+
+							std::tie(conflict.x, conflict.y) = getContact(footprint, other);
+
+							return true;
+						}
+					}
+				}
+			}
+
+			return false;
+		}
+
+	public:
+		/**
+		 * @brief Construct a new Conflict Checker
+		 *
+		 * @param timeStep Seconds between the poses that are compared, robots closing faster than robot width per step can
+		 * pass through each other
+		 * @param cellSize Width of a spatial hash cell in inches, about a robot width works best
+		 */
+		explicit ConflictChecker(float timeStep = 0.02, float cellSize = 16.0) : timeStep(timeStep), cellSize(cellSize) {}
+
+		void clearPartners() {
+			footprints.clear();
+			lastSteps.clear();
+			buckets.clear();
+			maxRadius = 0.0;
+		}
+
+		/**
+		 * @brief Add a partner path to check against
+		 *
+		 * @param path The planned path of the partner
+		 * @param startTime Seconds after the start of autonomous the partner starts driving
+		 * @param robotLength Length of the partner along its direction of travel in inches
+		 * @param robotWidth Width of the partner in inches
+		 */
+		void addPartner(const PlannedPath& path, float startTime, float robotLength, float robotWidth) {
+			if (path.size() == 0) {
+				return;
+			}
+
+			int partner = lastSteps.size();
+			int32_t lastStep = getLastStep(path, startTime);
+			lastSteps.emplace_back(lastStep);
+
+			forEachStep(path, startTime, lastStep, robotLength, robotWidth, [&](int32_t step, Footprint& footprint) {
+				footprint.partner = partner;
+				maxRadius = std::max(maxRadius, footprint.radius);
+
+				insert(step, footprint);
+
+				if (step == lastStep) {
+					insert(parkedStep, footprint);
+				}
+
+				return true;
+			});
+		}
+
+		/**
+		 * @brief Find the first time a path touches any partner
+		 *
+		 * @param path The planned path to check
+		 * @param startTime Seconds after the start of autonomous the robot starts driving
+		 * @param robotLength Length of the robot along its direction of travel in inches
+		 * @param robotWidth Width of the robot in inches
+		 * @return Conflict The first conflict, found is false if the robots never touch
+		 */
+		Conflict check(const PlannedPath& path, float startTime, float robotLength, float robotWidth) const {
+			Conflict conflict;
+
+			if (path.size() == 0 || lastSteps.empty()) {
+				return conflict;
+			}
+
+			// Run until every robot has stopped, after that nothing moves
+			int32_t lastStep = std::max(getLastStep(path, startTime), *std::max_element(lastSteps.begin(), lastSteps.end()) + 1);
+
+			forEachStep(path, startTime, lastStep, robotLength, robotWidth, [&](int32_t step, Footprint& footprint) {
+				return !findTouching(step, step, footprint, conflict) && !findTouching(step, parkedStep, footprint, conflict);
+			});
+
+			return conflict;
+		}
+	};
+} // namespace PathPlanner
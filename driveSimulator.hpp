@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "velocityPlanner.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Feedback controller the simulated robot follows a plan with
+	 */
+	enum class TrackingController {
+		/**
+		 * @brief Drives to the pose the plan has at each time, with the planned speeds as feedforward
+		 */
+		Ramsete,
+
+		/**
+		 * @brief Steers toward a point lookahead along the path from the closest sample, at the planned speed there
+		 */
+		PurePursuit
+	};
+
+	/**
+	 * @brief Robot and controller used for a simulated run
+	 */
+	struct SimulatorConfig {
+		QLength trackWidth = 8_in;
+
+		/**
+		 * @brief Fastest a wheel turns, commands over it are scaled down together so the robot keeps its curvature
+		 */
+		QSpeed maxWheelSpeed = 60_in/second;
+
+		/**
+		 * @brief Hardest a wheel can speed up or slow down
+		 */
+		QAcceleration maxWheelAcceleration = 100_in/second/second;
+
+		/**
+		 * @brief How quickly a wheel gets to a new speed when it isn't limited by maxWheelAcceleration
+		 */
+		QTime motorTimeConstant = 0.04_s;
+
+		/**
+		 * @brief Time from measuring the pose to the wheels acting on the command worked out from it
+		 */
+		QTime latency = 0.02_s;
+
+		QTime timeStep = 0.005_s;
+
+		/**
+		 * @brief Time the robot keeps following after the plan ends
+		 */
+		QTime settleTime = 0.5_s;
+
+		TrackingController controller = TrackingController::Ramsete;
+
+		/**
+		 * @brief RAMSETE gains in radians and meters, larger b corrects harder and zeta adds damping
+		 */
+		double ramseteB = 2.0;
+		double ramseteZeta = 0.7;
+
+		QLength lookahead = 12_in;
+	};
+
+	/**
+	 * @brief Where the simulated robot went and how far it was off the path, one sample per time step
+	 */
+	struct SimulationResult {
+		QuantityArray<QTime> time{second};
+		QuantityArray<QLength> positionX{inch};
+		QuantityArray<QLength> positionY{inch};
+
+		/**
+		 * @brief Sideways distance from the closest part of the path, positive toward the side the path turns to with
+		 * a positive curvature
+		 */
+		QuantityArray<QLength> crossTrackError{inch};
+
+		/**
+		 * @brief Robot heading minus the planned heading at the closest sample
+		 */
+		QuantityArray<Angle> headingError{degree};
+
+		/**
+		 * @brief How far along the path the robot is behind where the plan has it at that time
+		 */
+		QuantityArray<QLength> alongTrackError{inch};
+
+		QLength maxCrossTrackError = 0.0;
+		QLength rmsCrossTrackError = 0.0;
+		Angle maxHeadingError = 0.0;
+
+		/**
+		 * @brief Distance from the end of the path when the simulation stops
+		 */
+		QLength finalError = 0.0;
+
+		int size() const {
+			return time.size();
+		}
+	};
+
+	/**
+	 * @brief Headless closed loop run of a differential drive following a planned path
+	 *
+	 * Every time step the controller works out a speed and turn rate from the measured pose, they go to the wheels
+	 * after the latency, and each wheel moves toward its command with a first order lag limited by the wheel speed and
+	 * acceleration. The pose is integrated at the middle of the step. The run is a few floating point operations a step,
+	 * so a path simulates in well under a millisecond and can be rerun after every edit.
+	 *
+	 * Inside the simulator x and y are swapped from the field, so the headings and curvatures of the plan are the usual
+	 * counterclockwise ones and the heading goes up by the curvature per unit of distance.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class DriveSimulator {
+	private:
+		SimulatorConfig config;
+
+		static constexpr double closestWindow = 12.0 * 0.0254;
+
+		struct Pose {
+			double x;
+			double y;
+			double heading;
+		};
+
+		/**
+		 * @brief Plan at one time, speeds are signed by the way the robot faces
+		 */
+		struct Reference {
+			Pose pose;
+			double speed;
+			double angularSpeed;
+			double distance;
+		};
+
+		/**
+		 * @brief The plan in SI units and the simulator's frame
+		 */
+		struct Path {
+			std::vector<double> x;
+			std::vector<double> y;
+			std::vector<double> heading;
+			std::vector<double> speed;
+			std::vector<double> curvature;
+			std::vector<double> distance;
+			std::vector<double> time;
+
+			int size() const {
+				return x.size();
+			}
+		};
+
+		static double wrapAngle(double angle) {
+			return remainder(angle, 2.0 * M_PI);
+		}
+
+		static Path getPath(const PlannedPath& plannedPath) {
+			Path path;
+			int samples = plannedPath.size();
+
+			for (auto vector : {&path.x, &path.y, &path.heading, &path.speed, &path.curvature, &path.distance, &path.time}) {
+				vector->resize(samples);
+			}
+
+			for (int i = 0; i < samples; i++) {
+				path.x[i] = plannedPath.positionY[i].getValue();
+				path.y[i] = plannedPath.positionX[i].getValue();
+				path.heading[i] = plannedPath.heading[i].getValue();
+				path.speed[i] = plannedPath.limitedSpeed[i].getValue();
+				path.curvature[i] = plannedPath.curvatureByDistance[i].getValue();
+				path.distance[i] = plannedPath.distanceTotal[i].getValue();
+				path.time[i] = plannedPath.time[i].getValue();
+			}
+
+			return path;
+		}
+
+		/**
+		 * @brief Plan at a time, interpolated between samples. sample only moves forward so a whole run walks the plan
+		 * once.
+		 */
+		static Reference getReference(const Path& path, int& sample, double time) {
+			int last = path.size() - 1;
+
+			while (sample < last - 1 && path.time[sample + 1] <= time) {
+				sample++;
+			}
+
+			int next = std::min(sample + 1, last);
+			double duration = path.time[next] - path.time[sample];
+			double fraction = duration > 0.0 ? std::clamp((time - path.time[sample]) / duration, 0.0, 1.0) : 1.0;
+
+			auto interpolate = [&](const std::vector<double>& values) {
+				return values[sample] + (values[next] - values[sample]) * fraction;
+			};
+
+			Reference reference;
+			reference.pose = {interpolate(path.x), interpolate(path.y), path.heading[sample] + wrapAngle(path.heading[next] - path.heading[sample]) * fraction};
+			reference.speed = interpolate(path.speed);
+			reference.angularSpeed = fabs(reference.speed) * interpolate(path.curvature);
+
+			// A plan with a curvature that isn't finite still has to be followed somehow, going straight is the safest
+			if (!std::isfinite(reference.angularSpeed)) {
+				reference.angularSpeed = 0.0;
+			}
+			reference.distance = interpolate(path.distance);
+
+			return reference;
+		}
+
+		/**
+		 * @brief Closest sample within closestWindow after the last closest one
+		 *
+		 * The search doesn't look past a sample the plan stops on until the robot gets there, where the path turns back
+		 * on itself the samples after the stop are as close as the ones before it.
+		 */
+		static int getClosest(const Path& path, int closest, double x, double y) {
+			auto getDistanceSquared = [&](int i) {
+				return (path.x[i] - x) * (path.x[i] - x) + (path.y[i] - y) * (path.y[i] - y);
+			};
+
+			int best = closest;
+			double bestDistance = getDistanceSquared(closest);
+
+			for (int i = closest + 1; i < path.size() && path.distance[i] - path.distance[closest] <= closestWindow; i++) {
+				double distance = getDistanceSquared(i);
+
+				if (distance < bestDistance) {
+					best = i;
+					bestDistance = distance;
+				}
+
+				if (path.speed[i] == 0.0) {
+					break;
+				}
+			}
+
+			return best;
+		}
+
+		/**
+		 * @brief Speed and turn rate from RAMSETE, the unicycle tracking law with gains scaled by the planned speeds
+		 */
+		std::pair<double, double> getRamsete(const Pose& pose, const Reference& reference) const {
+			double dx = reference.pose.x - pose.x;
+			double dy = reference.pose.y - pose.y;
+
+			double forwardError = cos(pose.heading) * dx + sin(pose.heading) * dy;
+			double sidewaysError = -sin(pose.heading) * dx + cos(pose.heading) * dy;
+			double headingError = wrapAngle(reference.pose.heading - pose.heading);
+
+			double gain = 2.0 * config.ramseteZeta * sqrt(reference.angularSpeed * reference.angularSpeed + config.ramseteB * reference.speed * reference.speed);
+			double sinc = fabs(headingError) > 1.0e-6 ? sin(headingError) / headingError : 1.0;
+
+			return {reference.speed * cos(headingError) + gain * forwardError,
+					reference.angularSpeed + gain * headingError + config.ramseteB * reference.speed * sinc * sidewaysError};
+		}
+
+		/**
+		 * @brief Speed and turn rate from pure pursuit, the arc through the lookahead point at the planned speed
+		 *
+		 * The lookahead stops at samples the plan stops on so the robot doesn't cut across a change of direction. The
+		 * speed is taken from the first sample from the closest one on that isn't stopped, so it gets going from rest
+		 * even where the plan stays at 0 for a few samples.
+		 */
+		std::pair<double, double> getPurePursuit(const Path& path, const Pose& pose, int closest) const {
+			double lookahead = config.lookahead.getValue();
+			int target = closest;
+
+			while (target + 1 < path.size() && path.distance[target] - path.distance[closest] < lookahead) {
+				target++;
+
+				if (path.speed[target] == 0.0) {
+					break;
+				}
+			}
+
+			double dx = path.x[target] - pose.x;
+			double dy = path.y[target] - pose.y;
+
+			double forward = cos(pose.heading) * dx + sin(pose.heading) * dy;
+			double sideways = -sin(pose.heading) * dx + cos(pose.heading) * dy;
+			double distanceSquared = forward * forward + sideways * sideways;
+
+			double curvature = distanceSquared > 1.0e-9 ? 2.0 * sideways / distanceSquared : 0.0;
+			int moving = closest;
+			while (moving + 1 < path.size() && path.speed[moving] == 0.0) {
+				moving++;
+			}
+
+			double speed = path.speed[moving];
+
+			return {speed, speed * curvature};
+		}
+
+	public:
+		explicit DriveSimulator(SimulatorConfig config = {}) : config(config) {}
+
+		/**
+		 * @brief Follow a plan from its start until settleTime after it ends
+		 */
+		SimulationResult simulate(const PlannedPath& plannedPath) const {
+			SimulationResult result;
+
+			if (plannedPath.size() < 2) {
+				return result;
+			}
+
+			Path path = getPath(plannedPath);
+
+			double timeStep = config.timeStep.getValue();
+			double trackWidth = config.trackWidth.getValue();
+			double maxWheelSpeed = config.maxWheelSpeed.getValue();
+			double maxWheelAcceleration = config.maxWheelAcceleration.getValue();
+			double motorTimeConstant = std::max(config.motorTimeConstant.getValue(), timeStep);
+
+			int steps = ceil((plannedPath.duration + config.settleTime).getValue() / timeStep) + 1;
+
+			result.time.resize(steps);
+			result.positionX.resize(steps);
+			result.positionY.resize(steps);
+			result.crossTrackError.resize(steps);
+			result.headingError.resize(steps);
+			result.alongTrackError.resize(steps);
+
+			// Commands wait here for the latency, oldest at delayIndex
+			std::vector<std::pair<double, double>> delay((size_t) std::max(0.0, round(config.latency.getValue() / timeStep)), {0.0, 0.0});
+			size_t delayIndex = 0;
+
+			Pose pose{path.x[0], path.y[0], path.heading[0]};
+			double leftSpeed = 0.0;
+			double rightSpeed = 0.0;
+
+			int sample = 0;
+			int closest = 0;
+
+			double maxCrossTrackError = 0.0;
+			double sumSquaredCrossTrackError = 0.0;
+			double maxHeadingError = 0.0;
+
+			for (int step = 0; step < steps; step++) {
+				double time = step * timeStep;
+
+				Reference reference = getReference(path, sample, time);
+				closest = getClosest(path, closest, pose.x, pose.y);
+
+				// Errors against the direction of travel at the closest sample
+				int from = std::max(0, std::min(closest, path.size() - 2));
+				double tangentX = path.x[from + 1] - path.x[from];
+				double tangentY = path.y[from + 1] - path.y[from];
+				double tangentLength = hypot(tangentX, tangentY);
+
+				double dx = pose.x - path.x[closest];
+				double dy = pose.y - path.y[closest];
+				double crossTrackError = tangentLength > 0.0 ? (tangentX * dy - tangentY * dx) / tangentLength : hypot(dx, dy);
+				double alongTrack = tangentLength > 0.0 ? (tangentX * dx + tangentY * dy) / tangentLength : 0.0;
+				double headingError = wrapAngle(pose.heading - path.heading[closest]);
+
+				result.time.set(step, QTime(time));
+				result.positionX.set(step, QLength(pose.y));
+				result.positionY.set(step, QLength(pose.x));
+				result.crossTrackError.set(step, QLength(crossTrackError));
+				result.headingError.set(step, Angle(headingError));
+				result.alongTrackError.set(step, QLength(reference.distance - path.distance[closest] - alongTrack));
+
+				maxCrossTrackError = std::max(maxCrossTrackError, fabs(crossTrackError));
+				sumSquaredCrossTrackError += crossTrackError * crossTrackError;
+				maxHeadingError = std::max(maxHeadingError, fabs(headingError));
+
+				auto [speed, angularSpeed] = config.controller == TrackingController::Ramsete ? getRamsete(pose, reference) : getPurePursuit(path, pose, closest);
+
+				std::pair<double, double> command = {speed - angularSpeed * trackWidth * 0.5, speed + angularSpeed * trackWidth * 0.5};
+
+				// Scaling both wheels keeps the curvature when one of them is over the limit
+				double saturation = std::max(fabs(command.first), fabs(command.second)) / maxWheelSpeed;
+				if (saturation > 1.0) {
+					command.first /= saturation;
+					command.second /= saturation;
+				}
+
+				if (!delay.empty()) {
+					std::swap(command, delay[delayIndex]);
+					delayIndex = (delayIndex + 1) % delay.size();
+				}
+
+				auto getWheelSpeed = [&](double wheelSpeed, double commandedSpeed) {
+					double acceleration = std::clamp((commandedSpeed - wheelSpeed) / motorTimeConstant, -maxWheelAcceleration, maxWheelAcceleration);
+
+					return wheelSpeed + acceleration * timeStep;
+				};
+
+				leftSpeed = getWheelSpeed(leftSpeed, command.first);
+				rightSpeed = getWheelSpeed(rightSpeed, command.second);
+
+				double robotSpeed = 0.5 * (leftSpeed + rightSpeed);
+				double robotAngularSpeed = (rightSpeed - leftSpeed) / trackWidth;
+				double middleHeading = pose.heading + 0.5 * robotAngularSpeed * timeStep;
+
+				pose.x += robotSpeed * cos(middleHeading) * timeStep;
+				pose.y += robotSpeed * sin(middleHeading) * timeStep;
+				pose.heading += robotAngularSpeed * timeStep;
+			}
+
+			result.maxCrossTrackError = maxCrossTrackError;
+			result.rmsCrossTrackError = sqrt(sumSquaredCrossTrackError / steps);
+			result.maxHeadingError = maxHeadingError;
+			result.finalError = hypot(pose.x - path.x.back(), pose.y - path.y.back());
+
+			return result;
+		}
+
+		SimulatorConfig getConfig() const {
+			return config;
+		}
+
+		void setConfig(SimulatorConfig config) {
+			this->config = config;
+		}
+	};
+} // namespace PathPlanner
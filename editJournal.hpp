@@ -0,0 +1,443 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Editor independent copy of one spline, in screen coordinates like the editor stores it
+ */
+struct JournalSpline {
+	float points[4][2]{};
+	bool inverted{false};
+	std::string motionProfile;
+
+	bool operator==(const JournalSpline& other) const {
+		return memcmp(points, other.points, sizeof(points)) == 0 && inverted == other.inverted && motionProfile == other.motionProfile;
+	}
+
+	bool operator!=(const JournalSpline& other) const {
+		return !(*this == other);
+	}
+};
+
+/**
+ * @brief Append only log of edits to a path so nothing is lost if the editor crashes before a save
+ *
+ * Every edit is written as one or more fixed size records and flushed to the OS straight away. After enough records, or
+ * when asked, the current path is written to "<journal>.checkpoint" as the smallest list of records that rebuilds it and
+ * the journal is emptied, so recovering never has to replay more than a few thousand records.
+ *
+ * Records carry a sequence number, the checkpoint stores the last sequence it includes and recovery skips journal
+ * records up to it. That keeps recovery correct if the editor dies between writing the checkpoint and emptying the
+ * journal.
+ */
+class EditJournal {
+public:
+	enum RecordType : uint8_t {
+		// Remove every spline
+		Clear = 1,
+		// Insert a spline at spline, with inverted set to point and every point at (x, y)
+		AddSpline = 2,
+		DeleteSpline = 3,
+		MovePoint = 4,
+		// Set inverted of spline to point
+		SetInverted = 5,
+		// Resize the motion profile of spline to length characters and write the first characters from text
+		SetMotionProfile = 6,
+		// Write text into the motion profile of spline starting at length
+		MotionProfileText = 7,
+	};
+
+	struct Record {
+		uint32_t sequence;
+		uint8_t type;
+		uint8_t point;
+		uint16_t length;
+		uint32_t spline;
+		float x;
+		float y;
+		char text[8];
+		uint32_t checksum;
+	};
+
+	static_assert(sizeof(Record) == 32, "Journal records have to stay 32 bytes");
+
+	/**
+	 * @brief Number of journal records before the journal is compacted into a checkpoint
+	 */
+	static constexpr int compactionThreshold = 4096;
+
+private:
+	struct CheckpointHeader {
+		char magic[8];
+		uint32_t lastSequence;
+		uint32_t records;
+	};
+
+	static constexpr char checkpointMagic[8] = {'P', 'P', 'J', 'R', 'N', 'L', 'C', '1'};
+
+	std::string filename;
+	FILE* file{nullptr};
+
+	std::vector<JournalSpline> state;
+
+	uint32_t sequence{0};
+	int recordsSinceCheckpoint{0};
+
+	static uint32_t computeChecksum(const Record& record) {
+		// FNV-1a over everything but the checksum
+		const auto* bytes = reinterpret_cast<const unsigned char*>(&record);
+		uint32_t hash = 2166136261u;
+
+		for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+
+		return hash;
+	}
+
+	static Record makeRecord(RecordType type, uint32_t spline, uint8_t point = 0, float x = 0.0, float y = 0.0) {
+		Record record{};
+		record.type = type;
+		record.spline = spline;
+		record.point = point;
+		record.x = x;
+		record.y = y;
+		return record;
+	}
+
+	static void appendMotionProfile(std::vector<Record>& records, uint32_t spline, const std::string& motionProfile) {
+		size_t length = std::min<size_t>(motionProfile.size(), UINT16_MAX);
+
+		Record record = makeRecord(SetMotionProfile, spline);
+		record.length = length;
+		memcpy(record.text, motionProfile.data(), std::min<size_t>(length, sizeof(record.text)));
+		records.emplace_back(record);
+
+		for (size_t offset = sizeof(record.text); offset < length; offset += sizeof(record.text)) {
+			Record text = makeRecord(MotionProfileText, spline);
+			text.length = offset;
+			memcpy(text.text, motionProfile.data() + offset, std::min<size_t>(length - offset, sizeof(text.text)));
+			records.emplace_back(text);
+		}
+	}
+
+	static void appendSpline(std::vector<Record>& records, uint32_t index, const JournalSpline& spline) {
+		records.emplace_back(makeRecord(AddSpline, index, spline.inverted, spline.points[0][0], spline.points[0][1]));
+
+		for (int point = 1; point < 4; point++) {
+			records.emplace_back(makeRecord(MovePoint, index, point, spline.points[point][0], spline.points[point][1]));
+		}
+
+		appendMotionProfile(records, index, spline.motionProfile);
+	}
+
+	/**
+	 * @brief Records that turn the spline at index from before into after
+	 */
+	static void appendChanges(std::vector<Record>& records, uint32_t index, const JournalSpline& before, const JournalSpline& after) {
+		for (int point = 0; point < 4; point++) {
+			if (before.points[point][0] != after.points[point][0] || before.points[point][1] != after.points[point][1]) {
+				records.emplace_back(makeRecord(MovePoint, index, point, after.points[point][0], after.points[point][1]));
+			}
+		}
+
+		if (before.inverted != after.inverted) {
+			records.emplace_back(makeRecord(SetInverted, index, after.inverted));
+		}
+
+		if (before.motionProfile != after.motionProfile) {
+			appendMotionProfile(records, index, after.motionProfile);
+		}
+	}
+
+	/**
+	 * @brief Smallest list of records that builds a path from nothing
+	 */
+	static std::vector<Record> snapshotRecords(const std::vector<JournalSpline>& path) {
+		std::vector<Record> records = {makeRecord(Clear, 0)};
+
+		for (uint32_t i = 0; i < path.size(); i++) {
+			appendSpline(records, i, path.at(i));
+		}
+
+		return records;
+	}
+
+	/**
+	 * @brief Apply a record to a path, records that don't fit the path are ignored
+	 */
+	static void apply(std::vector<JournalSpline>& path, const Record& record) {
+		bool validSpline = record.spline < path.size();
+
+		switch (record.type) {
+			case Clear:
+				path.clear();
+				break;
+			case AddSpline:
+				if (record.spline <= path.size()) {
+					JournalSpline spline;
+					for (auto &point : spline.points) {
+						point[0] = record.x;
+						point[1] = record.y;
+					}
+					spline.inverted = record.point != 0;
+					path.insert(path.begin() + record.spline, spline);
+				}
+				break;
+			case DeleteSpline:
+				if (validSpline) {
+					path.erase(path.begin() + record.spline);
+				}
+				break;
+			case MovePoint:
+				if (validSpline && record.point < 4) {
+					path.at(record.spline).points[record.point][0] = record.x;
+					path.at(record.spline).points[record.point][1] = record.y;
+				}
+				break;
+			case SetInverted:
+				if (validSpline) {
+					path.at(record.spline).inverted = record.point != 0;
+				}
+				break;
+			case SetMotionProfile:
+				if (validSpline) {
+					std::string& motionProfile = path.at(record.spline).motionProfile;
+					motionProfile.assign(record.length, ' ');
+					memcpy(&motionProfile[0], record.text, std::min<size_t>(record.length, sizeof(record.text)));
+				}
+				break;
+			case MotionProfileText:
+				if (validSpline && record.length < path.at(record.spline).motionProfile.size()) {
+					std::string& motionProfile = path.at(record.spline).motionProfile;
+					memcpy(&motionProfile[record.length], record.text, std::min<size_t>(motionProfile.size() - record.length, sizeof(record.text)));
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	/**
+	 * @brief Read records from a file until the end or the first torn or corrupt record
+	 */
+	static std::vector<Record> readRecords(FILE* input, size_t maxRecords = SIZE_MAX) {
+		std::vector<Record> records;
+		Record record{};
+
+		while (records.size() < maxRecords && fread(&record, sizeof(Record), 1, input) == 1) {
+			if (record.checksum != computeChecksum(record)) {
+				break;
+			}
+			records.emplace_back(record);
+		}
+
+		return records;
+	}
+
+	void write(std::vector<Record>& records) {
+		if (file == nullptr || records.empty()) {
+			return;
+		}
+
+		for (auto &record : records) {
+			record.sequence = ++sequence;
+			record.checksum = computeChecksum(record);
+		}
+
+		fwrite(records.data(), sizeof(Record), records.size(), file);
+
+		// Hand the records to the OS now, a crash of the editor can't lose them after this
+		fflush(file);
+
+		recordsSinceCheckpoint += records.size();
+	}
+
+public:
+	EditJournal() = default;
+
+	EditJournal(const EditJournal&) = delete;
+	EditJournal& operator=(const EditJournal&) = delete;
+
+	/**
+	 * @brief Open a journal, replaying whatever it holds
+	 *
+	 * @param journalName The journal file, the checkpoint is kept next to it
+	 * @param recovered Set to the path the checkpoint and journal describe, left alone if there is nothing to recover
+	 * @return bool Whether a path was recovered
+	 */
+	bool open(const std::string& journalName, std::vector<JournalSpline>& recovered) {
+		close();
+
+		filename = journalName;
+		state.clear();
+		sequence = 0;
+		recordsSinceCheckpoint = 0;
+
+		bool found = false;
+		uint32_t checkpointSequence = 0;
+
+		if (FILE* checkpoint = fopen((filename + ".checkpoint").c_str(), "rb")) {
+			CheckpointHeader header{};
+
+			if (fread(&header, sizeof(header), 1, checkpoint) == 1 && memcmp(header.magic, checkpointMagic, sizeof(checkpointMagic)) == 0) {
+				std::vector<Record> records = readRecords(checkpoint, header.records);
+
+				// A checkpoint is written in one go, ignore it if it wasn't finished
+				if (records.size() == header.records) {
+					for (auto &record : records) {
+						apply(state, record);
+					}
+					checkpointSequence = header.lastSequence;
+					sequence = header.lastSequence;
+					found = true;
+				}
+			}
+
+			fclose(checkpoint);
+		}
+
+		if (FILE* journal = fopen(filename.c_str(), "rb")) {
+			for (auto &record : readRecords(journal)) {
+				if (record.sequence > checkpointSequence) {
+					apply(state, record);
+					sequence = std::max(sequence, record.sequence);
+					recordsSinceCheckpoint++;
+					found = true;
+				}
+			}
+
+			fclose(journal);
+		}
+
+		// Torn records at the end of the journal are dropped by starting again from a fresh checkpoint
+		file = fopen(filename.c_str(), "ab");
+		checkpoint();
+
+		if (found) {
+			recovered = state;
+		}
+
+		return found;
+	}
+
+	/**
+	 * @brief Journal the differences between the last recorded path and this one
+	 *
+	 * @param path The path as it is now
+	 */
+	void record(const std::vector<JournalSpline>& path) {
+		if (file == nullptr) {
+			return;
+		}
+
+		std::vector<Record> records;
+
+		size_t first = 0;
+		while (first < path.size() && first < state.size() && path.at(first) == state.at(first)) {
+			first++;
+		}
+
+		if (path.size() == state.size()) {
+			for (size_t i = first; i < path.size(); i++) {
+				appendChanges(records, i, state.at(i), path.at(i));
+			}
+		} else if (path.size() == state.size() + 1 && std::equal(state.begin() + first, state.end(), path.begin() + first + 1)) {
+			appendSpline(records, first, path.at(first));
+		} else if (path.size() + 1 == state.size() && std::equal(path.begin() + first, path.end(), state.begin() + first + 1)) {
+			records.emplace_back(makeRecord(DeleteSpline, first));
+		} else {
+			// Anything bigger, like an undo or opening a file, is journaled as the whole path
+			records = snapshotRecords(path);
+		}
+
+		if (records.empty()) {
+			return;
+		}
+
+		write(records);
+		state = path;
+
+		if (recordsSinceCheckpoint >= compactionThreshold) {
+			checkpoint();
+		}
+	}
+
+	/**
+	 * @brief Write the current path as a checkpoint and empty the journal
+	 */
+	void checkpoint() {
+		if (file == nullptr) {
+			return;
+		}
+
+		std::vector<Record> records = snapshotRecords(state);
+		for (auto &record : records) {
+			record.checksum = computeChecksum(record);
+		}
+
+		CheckpointHeader header{};
+		memcpy(header.magic, checkpointMagic, sizeof(checkpointMagic));
+		header.lastSequence = sequence;
+		header.records = records.size();
+
+		std::string checkpointName = filename + ".checkpoint";
+		std::string temporaryName = checkpointName + ".tmp";
+
+		FILE* checkpoint = fopen(temporaryName.c_str(), "wb");
+		if (checkpoint == nullptr) {
+			return;
+		}
+
+		bool written = fwrite(&header, sizeof(header), 1, checkpoint) == 1
+				&& fwrite(records.data(), sizeof(Record), records.size(), checkpoint) == records.size();
+
+		if (fclose(checkpoint) != 0 || !written) {
+			remove(temporaryName.c_str());
+			return;
+		}
+
+#ifdef _WIN32
+		remove(checkpointName.c_str());
+#endif
+
+		if (rename(temporaryName.c_str(), checkpointName.c_str()) != 0) {
+			remove(temporaryName.c_str());
+			return;
+		}
+
+		// Everything up to sequence is in the checkpoint now
+		fclose(file);
+		file = fopen(filename.c_str(), "wb");
+		recordsSinceCheckpoint = 0;
+	}
+
+	/**
+	 * @brief Stop journaling, optionally deleting the journal and checkpoint
+	 */
+	void close(bool discard = false) {
+		if (file != nullptr) {
+			fclose(file);
+			file = nullptr;
+		}
+
+		if (discard && !filename.empty()) {
+			remove(filename.c_str());
+			remove((filename + ".checkpoint").c_str());
+		}
+	}
+
+	int getRecordsSinceCheckpoint() const {
+		return recordsSinceCheckpoint;
+	}
+
+	~EditJournal() {
+		close();
+	}
+};
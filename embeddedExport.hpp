@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bezierSegment.hpp"
+#include "trajectoryCompressor.hpp"
+#include "velocityPlanner.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Number format of an embedded export
+	 */
+	enum class EmbeddedFormat {
+		Float32,
+
+		/**
+		 * @brief Signed 32 bit values with 16 fractional bits, the stored value divided by 65536
+		 */
+		Fixed16
+	};
+
+	/**
+	 * @brief One segment as it is laid out in an embedded export, x(t) = x[0] + x[1] t + x[2] t^2 + x[3] t^3 in inches
+	 */
+	template<typename Value>
+	struct EmbeddedSegment {
+		Value x[4];
+		Value y[4];
+		Value length;
+		uint8_t inverted;
+	};
+
+	/**
+	 * @brief One planner sample as it is laid out in an embedded export
+	 */
+	template<typename Value>
+	struct EmbeddedSample {
+		Value time;
+		Value distance;
+		Value velocity;
+		Value curvature;
+	};
+
+	/**
+	 * @brief Bytes an embedded export takes on the robot
+	 */
+	struct EmbeddedSize {
+		size_t segmentBytes = 0;
+		size_t profileBytes = 0;
+
+		/**
+		 * @brief Everything is constant data, the robot only needs RAM for its own copy if it makes one
+		 */
+		size_t getFlashBytes() const {
+			return segmentBytes + profileBytes + 2 * sizeof(uint32_t);
+		}
+	};
+
+	/**
+	 * @brief Writes a planned path as a C header of constant tables for robots without the memory or FPU for the
+	 * BezierSegment and QLength headers
+	 *
+	 * Segments are stored as power basis polynomial coefficients and the speed profile as (time, distance, velocity,
+	 * curvature) samples. Everything is a static const aggregate, so it is placed in flash and nothing runs at static
+	 * init or touches the heap. The header works from both C and C++.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class EmbeddedExporter {
+	private:
+		EmbeddedFormat format;
+		int profileStride;
+
+		// Export the samples the compressor keeps instead of every profileStride-th one
+		bool compressed{false};
+		TrajectoryCompressor compressor;
+
+		std::string formatValue(double value) const {
+			char buffer[32];
+
+			if (format == EmbeddedFormat::Float32) {
+				snprintf(buffer, sizeof(buffer), "%.9g", value);
+
+				// 12f isn't a float literal, 12.0f is
+				return std::string(buffer) + (strpbrk(buffer, ".e") == nullptr ? ".0f" : "f");
+			} else {
+				double scaled = std::clamp(round(value * 65536.0), (double) INT32_MIN, (double) INT32_MAX);
+				snprintf(buffer, sizeof(buffer), "%ld", (long) scaled);
+			}
+
+			return buffer;
+		}
+
+		const char* getSuffix() const {
+			return format == EmbeddedFormat::Float32 ? "F32" : "Q16";
+		}
+
+		/**
+		 * @brief Samples of the planned path that are exported, the compressor's knots or every profileStride-th one and
+		 * always the last
+		 */
+		std::vector<int> getExportedSamples(const PlannedPath& plannedPath) const {
+			if (compressed) {
+				return compressor.compress(plannedPath).knots;
+			}
+
+			std::vector<int> exported;
+
+			for (int i = 0; i < plannedPath.size(); i += profileStride) {
+				exported.emplace_back(i);
+			}
+
+			if (plannedPath.size() > 0 && exported.back() != plannedPath.size() - 1) {
+				exported.emplace_back(plannedPath.size() - 1);
+			}
+
+			return exported;
+		}
+
+	public:
+		/**
+		 * @brief Construct a new Embedded Exporter
+		 *
+		 * @param format Number format of the tables
+		 * @param profileStride Export every this many planner samples, the planner samples about once per inch unless its sampling is adaptive
+		 */
+		explicit EmbeddedExporter(EmbeddedFormat format = EmbeddedFormat::Float32, int profileStride = 1) : format(format), profileStride(std::max(1, profileStride)) {}
+
+		/**
+		 * @brief Construct a new Embedded Exporter that only exports the samples needed to interpolate the profile
+		 *
+		 * @param format Number format of the tables
+		 * @param tolerance Largest error linear interpolation between the exported samples can have
+		 */
+		EmbeddedExporter(EmbeddedFormat format, CompressionTolerance tolerance) : format(format), profileStride(1), compressed(true), compressor(tolerance) {}
+
+		/**
+		 * @brief Size of the export of a path
+		 */
+		EmbeddedSize getSize(size_t segments, const PlannedPath& plannedPath) const {
+			return getSize(segments, getExportedSamples(plannedPath).size());
+		}
+
+		/**
+		 * @brief Size of an export with a number of profile samples
+		 */
+		EmbeddedSize getSize(size_t segments, size_t samples) const {
+			EmbeddedSize size;
+
+			// Both formats use 4 byte values, so the layouts are the same size
+			size.segmentBytes = segments * sizeof(EmbeddedSegment<float>);
+			size.profileBytes = samples * sizeof(EmbeddedSample<float>);
+
+			return size;
+		}
+
+		/**
+		 * @brief Samples that are exported and the errors of interpolating between them
+		 */
+		CompressionResult getCompression(const PlannedPath& plannedPath) const {
+			if (compressed) {
+				return compressor.compress(plannedPath);
+			}
+
+			return compressor.measure(plannedPath, getExportedSamples(plannedPath));
+		}
+
+		/**
+		 * @brief Write the header for a path
+		 *
+		 * @param name Name of the path, used as the prefix of every table
+		 * @param segments Segments of the path
+		 * @param inverted Whether each segment is driven backwards
+		 * @param plannedPath The planned path of the segments
+		 * @return std::string Contents of the header
+		 */
+		std::string serialize(const std::string& name, std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const PlannedPath& plannedPath) const {
+			const double inchUnit = (1_in).getValue();
+
+			CompressionResult compression;
+			if (compressed) {
+				compression = compressor.compress(plannedPath);
+			}
+
+			std::vector<int> exported = compressed ? compression.knots : getExportedSamples(plannedPath);
+			EmbeddedSize size = getSize(segments.size(), exported.size());
+
+			const char* suffix = getSuffix();
+			const char* type = format == EmbeddedFormat::Float32 ? "float" : "int32_t";
+
+			std::ostringstream file;
+
+			file << "#pragma once" << "\n";
+			file << "#include <stdint.h>" << "\n";
+			file << "// PathPlanner made embedded path, " << (format == EmbeddedFormat::Float32 ? "float32" : "Q16.16 fixed point, value / 65536") << "\n";
+			file << "// Flash: " << size.getFlashBytes() << " bytes (" << size.segmentBytes << " segments, " << size.profileBytes << " profile), heap: 0 bytes" << "\n";
+
+			if (compressed) {
+				file << "// Profile: " << compression.knots.size() << " of " << compression.originalSamples << " samples, interpolate by time, worst error ";
+				file << compression.maxDistanceError.Convert(inch) << " in, " << compression.maxVelocityError.Convert(inch/second) << " in/s, ";
+				file << compression.maxCurvatureError.Convert(radian/inch) << " rad/in" << "\n";
+			}
+
+			file << "#ifndef PATH_PLANNER_EMBEDDED_" << suffix << "\n";
+			file << "#define PATH_PLANNER_EMBEDDED_" << suffix << "\n";
+			file << "// x(t) = x[0] + x[1] t + x[2] t^2 + x[3] t^3 in inches, t from 0 to 1" << "\n";
+			file << "typedef struct {" << "\n";
+			file << "\t" << type << " x[4];" << "\n";
+			file << "\t" << type << " y[4];" << "\n";
+			file << "\t" << type << " length;" << "\n";
+			file << "\tuint8_t inverted;" << "\n";
+			file << "} PathPlannerSegment" << suffix << ";" << "\n";
+			file << "// Seconds, inches, inches per second (negative backwards) and radians per inch" << "\n";
+			file << "typedef struct {" << "\n";
+			file << "\t" << type << " time;" << "\n";
+			file << "\t" << type << " distance;" << "\n";
+			file << "\t" << type << " velocity;" << "\n";
+			file << "\t" << type << " curvature;" << "\n";
+			file << "} PathPlannerSample" << suffix << ";" << "\n";
+			file << "#endif" << "\n";
+
+			file << "static const uint32_t " << name << "SegmentCount = " << segments.size() << ";" << "\n";
+			file << "static const PathPlannerSegment" << suffix << " " << name << "Segments[] = {" << "\n";
+
+			for (size_t i = 0; i < segments.size(); i++) {
+				BezierSegment& segment = segments.at(i);
+				double ax = segment.getA().getX().getValue() / inchUnit, ay = segment.getA().getY().getValue() / inchUnit;
+				double bx = segment.getB().getX().getValue() / inchUnit, by = segment.getB().getY().getValue() / inchUnit;
+				double cx = segment.getC().getX().getValue() / inchUnit, cy = segment.getC().getY().getValue() / inchUnit;
+				double dx = segment.getD().getX().getValue() / inchUnit, dy = segment.getD().getY().getValue() / inchUnit;
+
+				double x[4] = {ax, 3.0 * (bx - ax), 3.0 * (cx - 2.0 * bx + ax), dx - 3.0 * cx + 3.0 * bx - ax};
+				double y[4] = {ay, 3.0 * (by - ay), 3.0 * (cy - 2.0 * by + ay), dy - 3.0 * cy + 3.0 * by - ay};
+
+				file << "{{" << formatValue(x[0]) << ", " << formatValue(x[1]) << ", " << formatValue(x[2]) << ", " << formatValue(x[3]) << "}, ";
+				file << "{" << formatValue(y[0]) << ", " << formatValue(y[1]) << ", " << formatValue(y[2]) << ", " << formatValue(y[3]) << "}, ";
+				file << formatValue(fabs(segment.getDistance().getValue()) / inchUnit) << ", ";
+				file << (i < inverted.size() && inverted.at(i) ? 1 : 0) << "}," << "\n";
+			}
+
+			file << "};" << "\n";
+
+			file << "static const uint32_t " << name << "SampleCount = " << exported.size() << ";" << "\n";
+			file << "static const PathPlannerSample" << suffix << " " << name << "Profile[] = {" << "\n";
+
+			for (auto &i : exported) {
+				file << "{" << formatValue(plannedPath.time.at(i).Convert(second)) << ", " << formatValue(plannedPath.distanceTotal.at(i).Convert(inch)) << ", ";
+				file << formatValue(plannedPath.limitedSpeed.at(i).Convert(inch/second)) << ", " << formatValue(plannedPath.curvatureByDistance.at(i).Convert(radian/inch)) << "}," << "\n";
+			}
+
+			file << "};" << "\n";
+
+			return file.str();
+		}
+	};
+} // namespace PathPlanner
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "stb_image.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief RGBA pixels and mip levels of a field image
+ *
+ * Decoding the png with stb_image is slow, so the decoded levels are written to "<image>.cache" next to the png and
+ * mapped straight into memory the next time the image is loaded. The cache is used while the png's size and modified
+ * time match, or if the modified time changed but the png's contents hash to the same value.
+ */
+class FieldImage {
+public:
+	struct Level {
+		int width;
+		int height;
+		const unsigned char* pixels;
+	};
+
+private:
+	struct CacheHeader {
+		char magic[8];
+		uint32_t width;
+		uint32_t height;
+		uint32_t levels;
+		uint32_t reserved;
+		int64_t sourceModified;
+		uint64_t sourceSize;
+		uint64_t sourceHash;
+	};
+
+	static constexpr char cacheMagic[8] = {'P', 'P', 'F', 'I', 'E', 'L', 'D', '1'};
+
+	std::vector<Level> levels;
+
+	// Pixels decoded this run, empty when the levels point into the mapped cache
+	std::vector<unsigned char> ownedPixels;
+
+	void* mapping{nullptr};
+	size_t mappingSize{0};
+
+	static uint64_t hashFile(const std::string& filename) {
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+
+		FILE* file = fopen(filename.c_str(), "rb");
+		if (file == nullptr) {
+			return 0;
+		}
+
+		unsigned char buffer[65536];
+		size_t read;
+
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			for (size_t i = 0; i < read; i++) {
+				hash = (hash ^ buffer[i]) * 1099511628211ull;
+			}
+		}
+
+		fclose(file);
+
+		return hash;
+	}
+
+	static size_t levelsSize(int width, int height) {
+		size_t size = 0;
+
+		while (true) {
+			size += (size_t) width * height * 4;
+
+			if (width == 1 && height == 1) {
+				return size;
+			}
+
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+	}
+
+	/**
+	 * @brief Point the levels at consecutive mip levels starting at pixels
+	 */
+	void setLevels(const unsigned char* pixels, int width, int height) {
+		levels.clear();
+
+		while (true) {
+			levels.push_back({width, height, pixels});
+			pixels += (size_t) width * height * 4;
+
+			if (width == 1 && height == 1) {
+				return;
+			}
+
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+	}
+
+	void unmap() {
+#ifndef _WIN32
+		if (mapping != nullptr) {
+			munmap(mapping, mappingSize);
+		}
+#else
+		free(mapping);
+#endif
+		mapping = nullptr;
+		mappingSize = 0;
+	}
+
+	bool loadCache(const std::string& cacheName, const std::string& filename, const struct stat& source) {
+#ifndef _WIN32
+		int descriptor = ::open(cacheName.c_str(), O_RDONLY);
+		if (descriptor < 0) {
+			return false;
+		}
+
+		struct stat cacheStat{};
+		if (fstat(descriptor, &cacheStat) != 0 || cacheStat.st_size < (off_t) sizeof(CacheHeader)) {
+			close(descriptor);
+			return false;
+		}
+
+		mappingSize = cacheStat.st_size;
+		mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		close(descriptor);
+
+		if (mapping == MAP_FAILED) {
+			mapping = nullptr;
+			mappingSize = 0;
+			return false;
+		}
+#else
+		FILE* file = fopen(cacheName.c_str(), "rb");
+		if (file == nullptr) {
+			return false;
+		}
+
+		fseek(file, 0, SEEK_END);
+		mappingSize = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		mapping = malloc(mappingSize);
+		bool read = mappingSize >= sizeof(CacheHeader) && fread(mapping, 1, mappingSize, file) == mappingSize;
+		fclose(file);
+
+		if (!read) {
+			unmap();
+			return false;
+		}
+#endif
+
+		CacheHeader header{};
+		memcpy(&header, mapping, sizeof(CacheHeader));
+
+		bool valid = memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0
+				&& header.width > 0 && header.height > 0
+				&& header.sourceSize == (uint64_t) source.st_size
+				&& mappingSize == sizeof(CacheHeader) + levelsSize(header.width, header.height);
+
+		// A checkout or copy can touch the png without changing it, so fall back to the hash before decoding again
+		if (valid && header.sourceModified != (int64_t) source.st_mtime) {
+			valid = header.sourceHash == hashFile(filename);
+		}
+
+		if (!valid) {
+			unmap();
+			return false;
+		}
+
+		setLevels(static_cast<const unsigned char*>(mapping) + sizeof(CacheHeader), header.width, header.height);
+
+		return true;
+	}
+
+	bool decode(const std::string& filename) {
+		int width = 0;
+		int height = 0;
+		unsigned char* imageData = stbi_load(filename.c_str(), &width, &height, NULL, 4);
+		if (imageData == NULL) {
+			return false;
+		}
+
+		ownedPixels.resize(levelsSize(width, height));
+		memcpy(ownedPixels.data(), imageData, (size_t) width * height * 4);
+		stbi_image_free(imageData);
+
+		setLevels(ownedPixels.data(), width, height);
+
+		// Box filter each level down into the next one
+		for (size_t i = 1; i < levels.size(); i++) {
+			const Level& source = levels.at(i - 1);
+			Level& destination = levels.at(i);
+			auto* out = const_cast<unsigned char*>(destination.pixels);
+
+			for (int y = 0; y < destination.height; y++) {
+				for (int x = 0; x < destination.width; x++) {
+					int x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+					int y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+
+					for (int channel = 0; channel < 4; channel++) {
+						int sum = source.pixels[(y0 * source.width + x0) * 4 + channel]
+								+ source.pixels[(y0 * source.width + x1) * 4 + channel]
+								+ source.pixels[(y1 * source.width + x0) * 4 + channel]
+								+ source.pixels[(y1 * source.width + x1) * 4 + channel];
+						out[(y * destination.width + x) * 4 + channel] = (unsigned char) ((sum + 2) / 4);
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void writeCache(const std::string& cacheName, const std::string& filename, const struct stat& source) {
+		CacheHeader header{};
+		memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+		header.width = levels.front().width;
+		header.height = levels.front().height;
+		header.levels = levels.size();
+		header.sourceModified = source.st_mtime;
+		header.sourceSize = source.st_size;
+		header.sourceHash = hashFile(filename);
+
+		// Write to a temporary file first so a half written cache is never picked up
+		std::string temporaryName = cacheName + ".tmp";
+		FILE* file = fopen(temporaryName.c_str(), "wb");
+		if (file == nullptr) {
+			return;
+		}
+
+		bool written = fwrite(&header, sizeof(header), 1, file) == 1
+				&& fwrite(ownedPixels.data(), 1, ownedPixels.size(), file) == ownedPixels.size();
+
+		if (fclose(file) != 0 || !written || rename(temporaryName.c_str(), cacheName.c_str()) != 0) {
+			remove(temporaryName.c_str());
+		}
+	}
+
+public:
+	FieldImage() = default;
+
+	FieldImage(const FieldImage&) = delete;
+	FieldImage& operator=(const FieldImage&) = delete;
+
+	/**
+	 * @brief Load an image from its cache, or decode it and write the cache
+	 *
+	 * @param filename Path to the png
+	 * @return bool Whether the image could be loaded
+	 */
+	bool load(const std::string& filename) {
+		unmap();
+		ownedPixels.clear();
+		levels.clear();
+
+		struct stat source{};
+		if (stat(filename.c_str(), &source) != 0) {
+			return false;
+		}
+
+		std::string cacheName = filename + ".cache";
+
+		if (loadCache(cacheName, filename, source)) {
+			return true;
+		}
+
+		if (!decode(filename)) {
+			return false;
+		}
+
+		writeCache(cacheName, filename, source);
+
+		return true;
+	}
+
+	/**
+	 * @brief Find every png in a directory that isn't an obstacle mask, sorted by name
+	 */
+	static std::vector<std::string> findImages(const std::string& directory) {
+		std::vector<std::string> images;
+		std::error_code error;
+
+		for (auto &entry : std::filesystem::directory_iterator(directory, error)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".png" && entry.path().stem().extension() != ".mask") {
+				images.emplace_back(entry.path().string());
+			}
+		}
+
+		std::sort(images.begin(), images.end());
+
+		return images;
+	}
+
+	/**
+	 * @brief The full size image followed by every mip level down to 1x1
+	 */
+	const std::vector<Level>& getLevels() const {
+		return levels;
+	}
+
+	int getWidth() const {
+		return levels.empty() ? 0 : levels.front().width;
+	}
+
+	int getHeight() const {
+		return levels.empty() ? 0 : levels.front().height;
+	}
+
+	~FieldImage() {
+		unmap();
+	}
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Keeps a rolling window of how long each stage of the editor's main loop took
+	 *
+	 * Stages are timed with ScopedTimer, times recorded to the same stage in one frame are added together.
+	 */
+	class FrameProfiler {
+	public:
+		/**
+		 * @brief Number of frames kept for every stage
+		 */
+		static constexpr int historyLength = 600;
+
+		struct StageStatistics {
+			float min = 0.0;
+			float average = 0.0;
+			float p99 = 0.0;
+		};
+
+		/**
+		 * @brief Times a block and adds the elapsed time to a stage of the profiler when it goes out of scope
+		 */
+		class ScopedTimer {
+		private:
+			FrameProfiler& profiler;
+			int stage;
+			std::chrono::steady_clock::time_point start;
+		public:
+			ScopedTimer(FrameProfiler& profiler, const char* name) : profiler(profiler), stage(profiler.getStageIndex(name)), start(std::chrono::steady_clock::now()) {}
+
+			~ScopedTimer() {
+				profiler.record(stage, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
+		};
+
+	private:
+		struct Stage {
+			std::string name;
+			float current = 0.0;
+			std::vector<float> history = std::vector<float>(historyLength, 0.0);
+		};
+
+		std::vector<Stage> stages;
+
+		/**
+		 * @brief Index in every stage's history that the next frame is written to
+		 */
+		int next = 0;
+		int frames = 0;
+
+	public:
+		FrameProfiler() = default;
+
+		/**
+		 * @brief Get the index of a stage, adding the stage if it hasn't been seen before
+		 */
+		int getStageIndex(const char* name) {
+			for (int i = 0; i < stages.size(); i++) {
+				if (stages.at(i).name == name) {
+					return i;
+				}
+			}
+
+			stages.emplace_back();
+			stages.back().name = name;
+
+			return stages.size() - 1;
+		}
+
+		void record(int stage, float milliseconds) {
+			stages.at(stage).current += milliseconds;
+		}
+
+		/**
+		 * @brief Push this frame's times into the history and start a new frame
+		 */
+		void endFrame() {
+			for (auto &stage : stages) {
+				stage.history.at(next) = stage.current;
+				stage.current = 0.0;
+			}
+
+			next = (next + 1) % historyLength;
+			frames = std::min(frames + 1, historyLength);
+		}
+
+		int getStageCount() const {
+			return stages.size();
+		}
+
+		const std::string& getStageName(int stage) const {
+			return stages.at(stage).name;
+		}
+
+		/**
+		 * @brief Number of frames currently in the history
+		 */
+		int getFrameCount() const {
+			return frames;
+		}
+
+		/**
+		 * @brief Get the recorded times of a stage in milliseconds, oldest first
+		 */
+		std::vector<float> getHistory(int stage) const {
+			std::vector<float> result;
+			result.reserve(frames);
+
+			int first = (next - frames + historyLength) % historyLength;
+
+			for (int i = 0; i < frames; i++) {
+				result.emplace_back(stages.at(stage).history.at((first + i) % historyLength));
+			}
+
+			return result;
+		}
+
+		StageStatistics getStatistics(int stage) const {
+			StageStatistics statistics;
+			std::vector<float> history = getHistory(stage);
+
+			if (history.empty()) {
+				return statistics;
+			}
+
+			float total = 0.0;
+
+			for (auto &time : history) {
+				total += time;
+			}
+
+			statistics.average = total / (float) history.size();
+
+			std::sort(history.begin(), history.end());
+
+			statistics.min = history.front();
+			statistics.p99 = history.at(std::min<size_t>(history.size() - 1, (size_t) (0.99 * (double) history.size())));
+
+			return statistics;
+		}
+
+		/**
+		 * @brief Write the whole history as a csv with one row per frame and one column per stage
+		 *
+		 * @param filename The file to write to
+		 * @return bool Whether the file could be written
+		 */
+		bool dump(const std::string& filename) const {
+			std::ofstream file(filename);
+
+			if (!file) {
+				return false;
+			}
+
+			file << "frame";
+			for (auto &stage : stages) {
+				file << "," << stage.name;
+			}
+			file << "\n";
+
+			std::vector<std::vector<float>> histories;
+			for (int i = 0; i < stages.size(); i++) {
+				histories.emplace_back(getHistory(i));
+			}
+
+			for (int frame = 0; frame < frames; frame++) {
+				file << frame;
+				for (auto &history : histories) {
+					file << "," << history.at(frame);
+				}
+				file << "\n";
+			}
+
+			return file.good();
+		}
+	};
+} // namespace PathPlanner
@@ -0,0 +1,136 @@
+// Fuzz target for the path file reader
+//
+// Built with libFuzzer (PATH_PLANNER_LIBFUZZER defined, -fsanitize=fuzzer) it is a normal libFuzzer target. Otherwise it
+// is a standalone driver that reads every file given to it and then feeds the reader random mutations of them:
+//
+// Usage: path_file_fuzzer [--runs N] [--seed N] <corpus files...>
+
+#include "pathFile.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	std::string name;
+	std::vector<PathPlanner::PathFileSpline> splines;
+
+	PathPlanner::readPathFile(reinterpret_cast<const char*>(data), size, name, splines);
+
+	// Everything read has to be usable by the editor without further checks
+	for (auto &spline : splines) {
+		for (auto &point : spline.points) {
+			if (!std::isfinite(point[0]) || !std::isfinite(point[1])) {
+				abort();
+			}
+		}
+	}
+
+	if (splines.size() > size / 4 + 1) {
+		abort();
+	}
+
+	return 0;
+}
+
+#ifndef PATH_PLANNER_LIBFUZZER
+
+/**
+ * @brief Change the input a little, the same kinds of edits a person makes to a header by hand and some they don't
+ */
+std::string mutate(std::string input, const std::vector<std::string>& corpus, std::mt19937& random) {
+	static const char* tokens[] = {"PathPlanner::Point(", "_in", ", ", ")", "\n", "true", "false", "0.0", "{}", "nullptr",
+								   "std::vector ", "}", "getValue", "second", "1e308", "-", "nan", "inf", "+", "."};
+
+	int edits = 1 + random() % 8;
+
+	for (int edit = 0; edit < edits; edit++) {
+		size_t position = input.empty() ? 0 : random() % (input.size() + 1);
+
+		switch (random() % 6) {
+			case 0:
+				// Flip a byte
+				if (!input.empty()) {
+					input[random() % input.size()] ^= (char) (1 << (random() % 8));
+				}
+				break;
+			case 1:
+				// Delete a run of bytes
+				input.erase(position, random() % 16);
+				break;
+			case 2:
+				// Insert a token
+				input.insert(position, tokens[random() % (sizeof(tokens) / sizeof(tokens[0]))]);
+				break;
+			case 3:
+				// Insert a random digit string
+				input.insert(position, std::to_string((long long) random() - (long long) random()));
+				break;
+			case 4:
+				// Cut the file off
+				input.resize(position);
+				break;
+			default:
+				// Splice in part of another corpus file
+				if (!corpus.empty()) {
+					const std::string& other = corpus.at(random() % corpus.size());
+					size_t start = other.empty() ? 0 : random() % other.size();
+					input.insert(position, other.substr(start, random() % 256));
+				}
+				break;
+		}
+	}
+
+	return input;
+}
+
+int main(int argc, char** argv) {
+	long runs = 10000;
+	unsigned seed = 1;
+	std::vector<std::string> corpus;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			runs = atol(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else {
+			std::ifstream file(argv[i], std::ios::binary);
+			if (!file) {
+				fprintf(stderr, "Couldn't open %s\n", argv[i]);
+				return 1;
+			}
+
+			std::stringstream contents;
+			contents << file.rdbuf();
+			corpus.emplace_back(contents.str());
+		}
+	}
+
+	if (corpus.empty()) {
+		corpus.emplace_back("");
+	}
+
+	for (auto &input : corpus) {
+		LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+	}
+
+	std::mt19937 random(seed);
+
+	for (long run = 0; run < runs; run++) {
+		std::string input = mutate(corpus.at(random() % corpus.size()), corpus, random);
+		LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+	}
+
+	fprintf(stderr, "%ld runs over %zu corpus files without a crash\n", runs, corpus.size());
+
+	return 0;
+}
+
+#endif
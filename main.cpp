@@ -7,9 +7,25 @@
 #include "imgui/backends/imgui_impl_glfw.h"
 #include "imgui/backends/imgui_impl_opengl3.h"
 #include "bezierSegment.hpp"
+#include "velocityPlanner.hpp"
+#include "frameProfiler.hpp"
+#include "cachedDrawList.hpp"
+#include "fieldImage.hpp"
+#include "asyncFileWriter.hpp"
+#include "editJournal.hpp"
+#include "spatialGrid.hpp"
+#include "pathOptimizer.hpp"
+#include "pathSmoother.hpp"
+#include "pathFile.hpp"
+#include "obstacleMap.hpp"
+#include "conflictChecker.hpp"
+#include "embeddedExport.hpp"
+#include "telemetryLog.hpp"
+#include "driveSimulator.hpp"
 #include "implot/implot.h"
 #include <cstdio>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #define GL_SILENCE_DEPRECATION
 #if defined(IMGUI_IMPL_OPENGL_ES2)
@@ -64,6 +80,8 @@ private:
 
 	float curvature[100];
 
+	CachedDrawList drawCache;
+
 public:
 	Spline(ImVec2 lastPos, ImVec2 lastArm, ImVec2 mousePos, bool mouseInverted = false) {
 		this->points[0] = lastPos;
@@ -80,27 +98,44 @@ public:
 		this->motionProfile = std::move(motionProfile);
 	}
 
-	void printSpline(ImVec2 windowPosition) {
+	void printSpline(ImVec2 windowPosition, bool drawCurve = true) {
 		if (!displayed) {
 			return;
 		}
-		if (inverted) {
-			// Draw the Bézier curve under everything else
-			ImGui::GetForegroundDrawList()->AddBezierCubic(add(points[0], windowPosition), add(points[1], windowPosition), add(points[2], windowPosition), add(points[3], windowPosition), IM_COL32(103, 3, 47, 225), 2);
-		} else {
-			// Draw the Bézier curve under everything else
-			ImGui::GetForegroundDrawList()->AddBezierCubic(add(points[0], windowPosition), add(points[1], windowPosition), add(points[2], windowPosition), add(points[3], windowPosition), IM_COL32(255, 103, 0, 225), 2);
+
+		std::vector<float> key = {windowPosition.x, windowPosition.y, (float) inverted, (float) drawCurve};
+		for (auto &point : points) {
+			key.emplace_back(point.x);
+			key.emplace_back(point.y);
 		}
 
-		// Draw straight lines in between the control and the main points
-		ImGui::GetForegroundDrawList()->AddLine(add(points[0], windowPosition), add(points[1], windowPosition), IM_COL32(10, 10, 10, 255), 3);
-		ImGui::GetForegroundDrawList()->AddLine(add(points[2], windowPosition), add(points[3], windowPosition), IM_COL32(10, 10, 10, 255), 3);
+		// Only tessellate the curve again if it changed since the last frame
+		if (!drawCache.isValid(key)) {
+			ImDrawList* drawList = drawCache.begin();
+
+			// The curve is left out when the heatmap draws it instead
+			if (drawCurve && inverted) {
+				// Draw the Bézier curve under everything else
+				drawList->AddBezierCubic(add(points[0], windowPosition), add(points[1], windowPosition), add(points[2], windowPosition), add(points[3], windowPosition), IM_COL32(103, 3, 47, 225), 2);
+			} else if (drawCurve) {
+				// Draw the Bézier curve under everything else
+				drawList->AddBezierCubic(add(points[0], windowPosition), add(points[1], windowPosition), add(points[2], windowPosition), add(points[3], windowPosition), IM_COL32(255, 103, 0, 225), 2);
+			}
+
+			// Draw straight lines in between the control and the main points
+			drawList->AddLine(add(points[0], windowPosition), add(points[1], windowPosition), IM_COL32(10, 10, 10, 255), 3);
+			drawList->AddLine(add(points[2], windowPosition), add(points[3], windowPosition), IM_COL32(10, 10, 10, 255), 3);
+
+			// Draw circles on the beginning and end control and other points
+			drawList->AddCircleFilled(add(points[0], windowPosition), 8, IM_COL32(0, 255, 0, 255));
+			drawList->AddCircleFilled(add(points[1], windowPosition), 8, IM_COL32(0, 255, 0, 255));
+			drawList->AddCircleFilled(add(points[2], windowPosition), 10, IM_COL32(255, 0, 0, 255));
+			drawList->AddCircleFilled(add(points[3], windowPosition), 10, IM_COL32(255, 0, 0, 255));
 
-		// Draw circles on the beginning and end control and other points
-		ImGui::GetForegroundDrawList()->AddCircleFilled(add(points[0], windowPosition), 8, IM_COL32(0, 255, 0, 255));
-		ImGui::GetForegroundDrawList()->AddCircleFilled(add(points[1], windowPosition), 8, IM_COL32(0, 255, 0, 255));
-		ImGui::GetForegroundDrawList()->AddCircleFilled(add(points[2], windowPosition), 10, IM_COL32(255, 0, 0, 255));
-		ImGui::GetForegroundDrawList()->AddCircleFilled(add(points[3], windowPosition), 10, IM_COL32(255, 0, 0, 255));
+			drawCache.end(key);
+		}
+
+		drawCache.submit(ImGui::GetForegroundDrawList());
 	}
 
 	bool processMouse(ImVec2 windowPosition, bool overallFocus) {
@@ -179,6 +214,10 @@ public:
 		return &displayed;
 	}
 
+	bool hasFocus() const {
+		return isFocus[0] || isFocus[1] || isFocus[2] || isFocus[3];
+	}
+
 	PathPlanner::BezierSegment getBezierSegment() {
 		Spline converted = this->convertEntireToField();
 		PathPlanner::BezierSegment segment = PathPlanner::BezierSegment(
@@ -209,11 +248,9 @@ public:
 // Simple helper function to load an image into a OpenGL texture with common settings
 bool LoadTextureFromFile(const char* filename, GLuint* out_texture, int* out_width, int* out_height)
 {
-	// Load from file
-	int image_width = 0;
-	int image_height = 0;
-	unsigned char* image_data = stbi_load(filename, &image_width, &image_height, NULL, 4);
-	if (image_data == NULL)
+	// Load from the decoded cache, or from the png if there is no valid cache
+	FieldImage image;
+	if (!image.load(filename))
 		return false;
 
 	// Create a OpenGL texture identifier
@@ -222,123 +259,489 @@ bool LoadTextureFromFile(const char* filename, GLuint* out_texture, int* out_wid
 	glBindTexture(GL_TEXTURE_2D, image_texture);
 
 	// Setup filtering parameters for display
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // This is required on WebGL for non power-of-two textures
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); // Same
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint) image.getLevels().size() - 1);
 
-	// Upload pixels into texture
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
-	stbi_image_free(image_data);
+	// Upload pixels into texture, rows of the smaller levels aren't 4 byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int level = 0; level < image.getLevels().size(); level++) {
+		const FieldImage::Level& pixels = image.getLevels().at(level);
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, pixels.width, pixels.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.pixels);
+	}
 
 	*out_texture = image_texture;
-	*out_width = image_width;
-	*out_height = image_height;
+	*out_width = image.getWidth();
+	*out_height = image.getHeight();
 
 	return true;
 }
 
+enum HeatmapMode {
+	HeatmapNone,
+	HeatmapSpeed,
+	HeatmapCurvature,
+};
+
+// Blue at 0, through green and yellow to red at 1
+ImU32 heatmapColor(float fraction) {
+	fraction = std::min(std::max(fraction, 0.0f), 1.0f);
+
+	if (fraction < 0.5f) {
+		return IM_COL32(0, (int) (510 * fraction), (int) (255 * (1.0f - 2.0f * fraction)), 255);
+	}
+
+	return IM_COL32((int) (510 * (fraction - 0.5f)), (int) (255 * (2.0f - 2.0f * fraction)), 0, 255);
+}
+
+// A path another robot runs at the same time, only planned, drawn and checked against, never edited
+struct PartnerPath {
+	std::string filename;
+	std::vector<PathPlanner::BezierSegment> segments;
+	std::vector<bool> inverted;
+	PathPlanner::PlannedPath plannedPath;
+	float startTime = 0.0;
+};
+
+// Draw the footprint of the robot in red wherever it hits an obstacle, every few samples so overlapping footprints
+// don't hide the path
+void drawCollisions(ImDrawList* drawList, const PathPlanner::PlannedPath& plannedPath, const std::vector<float>& clearance, float robotLength, float robotWidth, ImVec2 windowPosition) {
+	for (int i = 0; i < clearance.size(); i++) {
+		if (clearance.at(i) >= 0.0 || (i % 4 != 0 && i != clearance.size() - 1)) {
+			continue;
+		}
+
+		int before = std::max(0, i - 1);
+		int after = std::min(plannedPath.size() - 1, i + 1);
+
+		const float* positionX = plannedPath.positionX.view(inch);
+		const float* positionY = plannedPath.positionY.view(inch);
+
+		float dx = positionX[after] - positionX[before];
+		float dy = positionY[after] - positionY[before];
+		float length = std::max(1.0e-6f, sqrtf(dx * dx + dy * dy));
+
+		dx /= length;
+		dy /= length;
+
+		ImVec2 corners[4];
+		float alongSigns[4] = {1, 1, -1, -1};
+		float acrossSigns[4] = {1, -1, -1, 1};
+
+		for (int corner = 0; corner < 4; corner++) {
+			float x = positionX[i] + dx * alongSigns[corner] * robotLength / 2.0 - dy * acrossSigns[corner] * robotWidth / 2.0;
+			float y = positionY[i] + dy * alongSigns[corner] * robotLength / 2.0 + dx * acrossSigns[corner] * robotWidth / 2.0;
+
+			corners[corner] = add(ImVec2(convertFromField(y), convertFromField(x)), windowPosition);
+		}
+
+		drawList->AddQuad(corners[0], corners[1], corners[2], corners[3], IM_COL32(230, 20, 20, 200), 1.5);
+	}
+}
+
+// Draw the partner paths thin and grey, and where the robots first meet
+void drawPartners(ImDrawList* drawList, const std::vector<PartnerPath>& partners, const PathPlanner::ConflictChecker::Conflict& conflict, float robotLength, ImVec2 windowPosition) {
+	std::vector<ImVec2> screenPoints;
+
+	for (auto &partner : partners) {
+		const PathPlanner::PlannedPath& plannedPath = partner.plannedPath;
+
+		screenPoints.resize(plannedPath.size());
+
+		const float* positionX = plannedPath.positionX.view(inch);
+		const float* positionY = plannedPath.positionY.view(inch);
+
+		for (int i = 0; i < plannedPath.size(); i++) {
+			screenPoints[i] = add(ImVec2(convertFromField(positionY[i]), convertFromField(positionX[i])), windowPosition);
+		}
+
+		drawList->AddPolyline(screenPoints.data(), screenPoints.size(), IM_COL32(120, 120, 120, 255), 0, 2.0);
+	}
+
+	if (conflict.found) {
+		ImVec2 center = add(ImVec2(convertFromField(conflict.y), convertFromField(conflict.x)), windowPosition);
+		char label[32];
+		snprintf(label, sizeof(label), "%.2f s", conflict.time);
+
+		drawList->AddCircle(center, convertFromField(robotLength / 2.0), IM_COL32(230, 20, 20, 255), 0, 3.0);
+		drawList->AddText(add(center, ImVec2(convertFromField(robotLength / 2.0), 0.0)), IM_COL32(230, 20, 20, 255), label);
+	}
+}
+
+// Draw the recorded path of the robot over the plan, decimated so it is a few thousand points however long the log is
+void drawTelemetry(ImDrawList* drawList, const PathPlanner::TelemetryTrace& trace, ImVec2 windowPosition) {
+	std::vector<ImVec2> screenPoints(trace.size());
+
+	const float* x = trace.get(PathPlanner::TelemetryX);
+	const float* y = trace.get(PathPlanner::TelemetryY);
+
+	for (size_t i = 0; i < trace.size(); i++) {
+		screenPoints[i] = add(ImVec2(convertFromField(y[i]), convertFromField(x[i])), windowPosition);
+	}
+
+	drawList->AddPolyline(screenPoints.data(), screenPoints.size(), IM_COL32(255, 150, 30, 255), 0, 2.0);
+}
+
+// Draw where the simulated follower drove over the plan
+void drawSimulation(ImDrawList* drawList, const PathPlanner::SimulationResult& simulation, ImVec2 windowPosition) {
+	std::vector<ImVec2> screenPoints(simulation.size());
+
+	const float* positionX = simulation.positionX.view(inch);
+	const float* positionY = simulation.positionY.view(inch);
+
+	for (int i = 0; i < simulation.size(); i++) {
+		screenPoints[i] = add(ImVec2(convertFromField(positionY[i]), convertFromField(positionX[i])), windowPosition);
+	}
+
+	drawList->AddPolyline(screenPoints.data(), screenPoints.size(), IM_COL32(40, 200, 230, 255), 0, 2.0);
+}
+
+// Obstacles for a field image are read from <image>.obstacles and <image>.mask.png next to it, both are optional
+void loadObstacles(PathPlanner::ObstacleMap& obstacleMap, const std::string& fieldImage) {
+	std::string base = fieldImage.substr(0, fieldImage.rfind(".png"));
+
+	obstacleMap.clear();
+	obstacleMap.loadPolygons(base + ".obstacles");
+
+	FieldImage mask;
+	if (mask.load(base + ".mask.png")) {
+		obstacleMap.addMask(mask.getLevels().front().pixels, mask.getWidth(), mask.getHeight());
+	}
+
+	obstacleMap.build();
+}
+
+// Draw the planned path as one quad per sample, colored by the value at each sample. All the quads go into the draw
+// list in a few large batches instead of one draw call per segment. Quads on splines that aren't displayed are left out,
+// a quad belongs to the spline its middle is on.
+void drawHeatmap(ImDrawList* drawList, const PathPlanner::PlannedPath& plannedPath, const float* values, std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& displayed, ImVec2 windowPosition, float thickness = 4.0) {
+	int samples = plannedPath.size();
+
+	if (samples < 2 || segments.empty()) {
+		return;
+	}
+
+	const float* distances = plannedPath.distanceTotal.view(inch);
+
+	std::vector<int> quadStarts;
+	int segment = 0;
+	float segmentEnd = segments.front().getDistance().Convert(inch);
+
+	// Distance only goes up so the spline is found by walking forwards from the last one
+	for (int i = 0; i < samples - 1; i++) {
+		float middle = 0.5f * (distances[i] + distances[i + 1]);
+
+		while (segment < (int) segments.size() - 1 && middle >= segmentEnd) {
+			segment++;
+			segmentEnd += segments.at(segment).getDistance().Convert(inch);
+		}
+
+		if (displayed.at(segment)) {
+			quadStarts.emplace_back(i);
+		}
+	}
+
+	// The colors are scaled to the part of the path that is shown
+	float maxValue = 0.0;
+	for (int i : quadStarts) {
+		maxValue = std::max(maxValue, std::max(std::abs(values[i]), std::abs(values[i + 1])));
+	}
+
+	if (maxValue == 0.0) {
+		maxValue = 1.0;
+	}
+
+	std::vector<ImVec2> screenPoints(samples);
+	std::vector<ImU32> colors(samples);
+
+	const float* positionX = plannedPath.positionX.view(inch);
+	const float* positionY = plannedPath.positionY.view(inch);
+
+	for (int i = 0; i < samples; i++) {
+		screenPoints[i] = add(ImVec2(convertFromField(positionY[i]), convertFromField(positionX[i])), windowPosition);
+		colors[i] = heatmapColor(std::abs(values[i]) / maxValue);
+	}
+
+	ImVec2 whitePixel = ImGui::GetDrawListSharedData()->TexUvWhitePixel;
+
+	// Keep every batch well under the 16 bit index limit
+	const int quadsPerBatch = 8192;
+
+	for (int batchStart = 0; batchStart < (int) quadStarts.size(); batchStart += quadsPerBatch) {
+		int quads = std::min(quadsPerBatch, (int) quadStarts.size() - batchStart);
+
+		drawList->PrimReserve(quads * 6, quads * 4);
+
+		for (int quad = batchStart; quad < batchStart + quads; quad++) {
+			int i = quadStarts[quad];
+			ImVec2 direction = minus(screenPoints[i + 1], screenPoints[i]);
+			float directionLength = distance(screenPoints[i + 1], screenPoints[i]);
+
+			ImVec2 normal = directionLength > 0.0f ? mult(ImVec2(-direction.y, direction.x), 0.5 * thickness / directionLength) : ImVec2(0.0, 0.0);
+
+			ImDrawIdx first = (ImDrawIdx) drawList->_VtxCurrentIdx;
+
+			drawList->PrimWriteVtx(add(screenPoints[i], normal), whitePixel, colors[i]);
+			drawList->PrimWriteVtx(minus(screenPoints[i], normal), whitePixel, colors[i]);
+			drawList->PrimWriteVtx(minus(screenPoints[i + 1], normal), whitePixel, colors[i + 1]);
+			drawList->PrimWriteVtx(add(screenPoints[i + 1], normal), whitePixel, colors[i + 1]);
+
+			drawList->PrimWriteIdx(first);
+			drawList->PrimWriteIdx(first + 1);
+			drawList->PrimWriteIdx(first + 2);
+			drawList->PrimWriteIdx(first);
+			drawList->PrimWriteIdx(first + 2);
+			drawList->PrimWriteIdx(first + 3);
+		}
+	}
+}
+
+// Draw the per stage frame times, the table shows the rolling min/avg/p99 and the plots the recent history
+void drawProfiler(PathPlanner::FrameProfiler& profiler) {
+	ImGui::Begin("Profiler", NULL);
+
+	ImGui::Text("F12 to dump a capture of the last %d frames", profiler.getFrameCount());
+
+	if (ImGui::BeginTable("Stages", 4)) {
+		ImGui::TableSetupColumn("Stage");
+		ImGui::TableSetupColumn("min ms");
+		ImGui::TableSetupColumn("avg ms");
+		ImGui::TableSetupColumn("p99 ms");
+		ImGui::TableHeadersRow();
+
+		for (int i = 0; i < profiler.getStageCount(); i++) {
+			PathPlanner::FrameProfiler::StageStatistics statistics = profiler.getStatistics(i);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(profiler.getStageName(i).c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", statistics.min);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", statistics.average);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", statistics.p99);
+		}
+
+		ImGui::EndTable();
+	}
+
+	std::vector<std::vector<float>> histories;
+
+	for (int i = 0; i < profiler.getStageCount(); i++) {
+		histories.emplace_back(profiler.getHistory(i));
+	}
+
+	ImPlot::SetNextAxesToFit();
+	if (ImPlot::BeginPlot("Stage Time By Frame")) {
+		ImPlot::SetupAxes("frame", "ms");
+		for (int i = 0; i < histories.size(); i++) {
+			ImPlot::PlotLine(profiler.getStageName(i).c_str(), histories.at(i).data(), histories.at(i).size());
+		}
+		ImPlot::EndPlot();
+	}
+
+	ImPlot::SetNextAxesToFit();
+	if (ImPlot::BeginPlot("Stage Time Histogram")) {
+		ImPlot::SetupAxes("ms", "frames");
+		for (int i = 0; i < histories.size(); i++) {
+			ImPlot::PlotHistogram(profiler.getStageName(i).c_str(), histories.at(i).data(), histories.at(i).size());
+		}
+		ImPlot::EndPlot();
+	}
+
+	ImGui::End();
+}
+
 static void glfw_error_callback(int error, const char* description)
 {
 	fprintf(stderr, "GLFW Error %d: %s\n", error, description);
 }
 
-void save(std::vector<Spline> path, std::string filename, std::string name) {
+// Put every control point in the grid, point i of spline n has the id n*4 + i
+void rebuildControlPoints(PathPlanner::SpatialGrid& controlPoints, std::vector<Spline>& path) {
+	controlPoints.clear();
+
+	for (int i = 0; i < path.size(); i++) {
+		for (int point = 0; point < 4; point++) {
+			controlPoints.update(i * 4 + point, path.at(i).get(point).x, path.at(i).get(point).y);
+		}
+	}
+}
+
+// Control points of every spline in field inches, as the optimizer works on them
+std::vector<PathPlanner::ControlPoints> toControlPoints(std::vector<Spline>& path) {
+	std::vector<PathPlanner::ControlPoints> controlPoints;
+
+	for (auto &spline : path) {
+		Spline converted = spline.convertEntireToField();
+		PathPlanner::ControlPoints points;
+
+		for (int i = 0; i < 4; i++) {
+			points[i] = PathPlanner::Point(converted.get(i).x * 1_in, converted.get(i).y * 1_in);
+		}
+
+		controlPoints.emplace_back(points);
+	}
+
+	return controlPoints;
+}
+
+void applyControlPoints(std::vector<Spline>& path, std::vector<PathPlanner::ControlPoints>& controlPoints) {
+	for (int i = 0; i < path.size() && i < controlPoints.size(); i++) {
+		for (int point = 0; point < 4; point++) {
+			*path.at(i).getPointer(point) = ImVec2(convertFromField(controlPoints.at(i)[point].getY().Convert(inch)),
+												   convertFromField(controlPoints.at(i)[point].getX().Convert(inch)));
+		}
+	}
+}
+
+std::vector<JournalSpline> toJournal(std::vector<Spline>& path) {
+	std::vector<JournalSpline> journalPath(path.size());
+
+	for (int i = 0; i < path.size(); i++) {
+		for (int point = 0; point < 4; point++) {
+			journalPath.at(i).points[point][0] = path.at(i).get(point).x;
+			journalPath.at(i).points[point][1] = path.at(i).get(point).y;
+		}
+		journalPath.at(i).inverted = *path.at(i).getInverted();
+		journalPath.at(i).motionProfile = path.at(i).getMotionProfiling();
+	}
+
+	return journalPath;
+}
+
+std::vector<Spline> fromJournal(const std::vector<JournalSpline>& journalPath) {
+	std::vector<Spline> path;
+
+	for (auto &spline : journalPath) {
+		path.emplace_back(ImVec2(spline.points[0][0], spline.points[0][1]), ImVec2(spline.points[1][0], spline.points[1][1]),
+						  ImVec2(spline.points[2][0], spline.points[2][1]), ImVec2(spline.points[3][0], spline.points[3][1]),
+						  spline.inverted, spline.motionProfile);
+	}
+
+	return path;
+}
+
+// Generate the header file for a path, run on the save thread
+std::string serialize(std::vector<Spline> path, std::string name) {
 	std::vector<Spline> convertedPath;
 
 	for (auto &item: path) {
 		convertedPath.emplace_back(item.convertEntireToField());
 	}
 
-	std::ofstream file(filename);
-
-	file.clear();
+	std::ostringstream file;
 
-	file << "#pragma once" << std::endl;
-	file << "#include <vector>" << std::endl;
+	file << "#pragma once" << "\n";
+	file << "#include <vector>" << "\n";
 	file << "#include \"velocityProfile/sinusoidalVelocityProfile.hpp\"\n"
-			"using namespace Pronounce;" << std::endl;
+			"using namespace Pronounce;" << "\n";
 
 	file << "std::vector<std::pair<PathPlanner::BezierSegment, QSpeed>> " << name << " = " << "{";
 
 	for (auto &item: convertedPath) {
-		file << "{PathPlanner::BezierSegment(" << std::endl;
+		file << "{PathPlanner::BezierSegment(" << "\n";
 		for (int i = 0; i < 4; i++) {
 			file << "PathPlanner::Point(" << item.get(i).x << "_in, " << item.get(i).y << "_in)";
 			if (i != 3) {
 				file << ",";
 			}
-			file << std::endl;
+			file << "\n";
 		}
-		std::cout << *item.getInverted() << std::endl;
 		file << "," << (*item.getInverted() ? "true" : "false");
-		file << ")," << std::endl << item.getMotionProfiling() << "}," << std::endl;
+		file << ")," << "\n" << item.getMotionProfiling() << "}," << "\n";
 	}
 
-	file << "};" << std::endl;
+	file << "};" << "\n";
 
-	file << "// PathPlanner made path" << std::endl;
+	file << "// PathPlanner made path" << "\n";
 
-	file.close();
+	return file.str();
+}
+
+// Exporter for the export settings, compressed exports keep only the samples needed to stay within the tolerance
+PathPlanner::EmbeddedExporter getExporter(PathPlanner::EmbeddedFormat format, int profileStride, bool compress, PathPlanner::CompressionTolerance tolerance) {
+	if (compress) {
+		return {format, tolerance};
+	}
+
+	return PathPlanner::EmbeddedExporter(format, profileStride);
+}
+
+// Queue an export of the planned path as constant tables next to the path file, returns the size on the robot
+PathPlanner::EmbeddedSize exportEmbedded(AsyncFileWriter& writer, PathPlanner::EmbeddedFormat format, const PathPlanner::EmbeddedExporter& exporter, std::vector<PathPlanner::BezierSegment> segments, std::vector<bool> inverted, PathPlanner::PlannedPath plannedPath, std::string filename, std::string name) {
+	PathPlanner::EmbeddedSize size = exporter.getSize(segments.size(), plannedPath);
+
+	filename = filename.substr(0, filename.rfind(".hpp")) + (format == PathPlanner::EmbeddedFormat::Float32 ? ".f32.h" : ".q16.h");
+
+	writer.write(std::move(filename), [exporter, segments, inverted, plannedPath, name]() mutable {
+		return exporter.serialize(name, segments, inverted, plannedPath);
+	});
+
+	return size;
+}
+
+// Queue a save of a snapshot of the path, returns the generation to wait for
+unsigned long save(AsyncFileWriter& writer, const std::vector<Spline>& path, std::string filename, std::string name) {
+	return writer.write(std::move(filename), [path, name]() {
+		return serialize(path, name);
+	});
 }
 
 void open(std::string filename, std::vector<Spline>* path) {
 
 	std::ifstream file(filename);
 
-	std::string myText;
-
-	std::vector<std::string> pointsString;
-	std::vector<bool> invertedString;
-	std::vector<std::string> motionProfiles;
-
-// Use a while loop together with the getline() function to read the file line by line
-	while (getline (file, myText)) {
-		// Output the text from the file
-		if (myText.find("PathPlanner::Point") != -1) {
-			std::cout << myText.substr(strlen("PathPlanner::Point("), myText.find(")")-myText.find("(") -1) << std::endl;
-			pointsString.emplace_back(myText.substr(strlen("PathPlanner::Point("), myText.find(")")-myText.find("(") -1));
-		} else if (myText.find("true") != -1) {
-			std::cout << myText << std::endl;
-			invertedString.emplace_back(true);
-		} else if (myText.find("false") != -1) {
-			std::cout << myText << std::endl;
-			invertedString.emplace_back(false);
-		} else if (myText.find("std::vector") != -1) {
-			pathName = myText.substr(myText.find(' ', myText.find(' ') + 1)+1,
-									 myText.find(' ', myText.find(' ', myText.find(' ') + 1) + 1) - myText.find(' ', myText.find(' ') + 1)-1);
-		} else if (myText.find("{}") != -1 || myText.find("0.0") != -1) {
-			motionProfiles.emplace_back("0.0");
-		} else if (myText.find("getValue") != -1 || myText.find("second") != -1) {
-			motionProfiles.emplace_back(myText.substr(0, myText.find('}')));
-		}
+	std::vector<PathPlanner::PathFileSpline> fileSplines;
+	if (!PathPlanner::readPathFile(file, pathName, fileSplines)) {
+		std::cout << "Parts of " << filename << " couldn't be read and were skipped" << std::endl;
 	}
 
 	path->clear();
 
-	for (int i = 0; i < pointsString.size(); i += 4) {
+	for (auto &fileSpline : fileSplines) {
 		path->emplace_back(
-				ImVec2(atof(pointsString[i].substr(0, pointsString[i].find("_")).c_str()), atof(pointsString[i].substr(pointsString[i].find(" "), pointsString[i].find("_", pointsString[i].find("_") + 1)).c_str())),
-				ImVec2(atof(pointsString[i+1].substr(0, pointsString[i+1].find("_")).c_str()), atof(pointsString[i+1].substr(pointsString[i+1].find(" "), pointsString[i+1].find("_", pointsString[i+1].find("_") + 1)).c_str())),
-				ImVec2(atof(pointsString[i+2].substr(0, pointsString[i+2].find("_")).c_str()), atof(pointsString[i+2].substr(pointsString[i+2].find(" "), pointsString[i+2].find("_", pointsString[i+2].find("_") + 1)).c_str())),
-				ImVec2(atof(pointsString[i+3].substr(0, pointsString[i+3].find("_")).c_str()), atof(pointsString[i+3].substr(pointsString[i+3].find(" "), pointsString[i+3].find("_", pointsString[i+3].find("_") + 1)).c_str()))
-				);
-		path->at(i/4).convertBack();
+				ImVec2(fileSpline.points[0][0], fileSpline.points[0][1]),
+				ImVec2(fileSpline.points[1][0], fileSpline.points[1][1]),
+				ImVec2(fileSpline.points[2][0], fileSpline.points[2][1]),
+				ImVec2(fileSpline.points[3][0], fileSpline.points[3][1]),
+				fileSpline.inverted, fileSpline.motionProfile);
+		path->back().convertBack();
 	}
 
-	for (int i = 0; i < path->size(); i++) {
-		*(path->at(i).getInverted()) = invertedString.at(i);
+	if (path->empty()) {
+		path->emplace_back(ImVec2(400, 50), ImVec2(700, 50), ImVec2(50, 200));
 	}
 
-	for (int i = 0; i < path->size(); i++) {
-		*(path->at(i).getMPPointer()) = motionProfiles.at(i);
+	file.close();
+}
+
+bool openPartner(const std::string& filename, PartnerPath& partner) {
+	std::ifstream file(filename);
+
+	std::string name;
+	std::vector<PathPlanner::PathFileSpline> fileSplines;
+	if (!PathPlanner::readPathFile(file, name, fileSplines)) {
+		std::cout << "Parts of " << filename << " couldn't be read and were skipped" << std::endl;
 	}
 
-	if (path->empty()) {
-		path->emplace_back(ImVec2(400, 50), ImVec2(700, 50), ImVec2(50, 200));
+	partner.filename = filename;
+	partner.segments.clear();
+	partner.inverted.clear();
+
+	for (auto &fileSpline : fileSplines) {
+		partner.segments.emplace_back(
+				PathPlanner::Point(fileSpline.points[0][0] * 1_in, fileSpline.points[0][1] * 1_in),
+				PathPlanner::Point(fileSpline.points[1][0] * 1_in, fileSpline.points[1][1] * 1_in),
+				PathPlanner::Point(fileSpline.points[2][0] * 1_in, fileSpline.points[2][1] * 1_in),
+				PathPlanner::Point(fileSpline.points[3][0] * 1_in, fileSpline.points[3][1] * 1_in));
+		partner.inverted.emplace_back(fileSpline.inverted);
 	}
 
-	file.close();
+	return !partner.segments.empty();
 }
 
 // Main code
@@ -382,22 +785,96 @@ int main(int, char**)
 	int my_image_width = 0;
 	int my_image_height = 0;
 
+	// Field images that can be picked from, the default field is loaded first
+	std::vector<std::string> fieldImages = FieldImage::findImages("./images");
+	int fieldImageIndex = std::max<int>(0, std::find(fieldImages.begin(), fieldImages.end(), "./images/field.png") - fieldImages.begin());
+	if (fieldImageIndex >= fieldImages.size()) {
+		fieldImageIndex = 0;
+	}
+
 	// Load texture from file
 	GLuint my_image_texture = 0;
-	bool ret = LoadTextureFromFile("./images/field.png", &my_image_texture, &my_image_width, &my_image_height);
+	bool ret = !fieldImages.empty() && LoadTextureFromFile(fieldImages.at(fieldImageIndex).c_str(), &my_image_texture, &my_image_width, &my_image_height);
 
 	// Make sure that the file is not null
 	IM_ASSERT(ret);
 
+	PathPlanner::ObstacleMap obstacleMap;
+	loadObstacles(obstacleMap, fieldImages.at(fieldImageIndex));
+	std::vector<float> clearance;
+
+	std::vector<PartnerPath> partners;
+	PathPlanner::ConflictChecker conflictChecker;
+	bool partnersDirty = false;
+
+	// Recorded odometry drawn against the plan, the traces are decimated again only when the log or the alignment changes
+	PathPlanner::TelemetryLog telemetryLog;
+	bool alignLog = true;
+	float logShift = 0.0;
+	PathPlanner::TelemetryTrace logFieldTrace;
+	PathPlanner::TelemetryTrace logSpeedTrace;
+	size_t tracedRows = 0;
+	float tracedStart = NAN;
+	float tracedEnd = NAN;
+
+	bool smoothWhileDragging = false;
+
 	// Our state
 	ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
 	std::vector<Spline> splines = {Spline(ImVec2(400, 50), ImVec2(700, 50), ImVec2(50, 200))};
 	std::vector<std::vector<Spline>> history = {splines};
 
+	// Every edit is journaled so a crash doesn't lose unsaved work, the journal is only left behind if the editor
+	// doesn't exit cleanly. Paths that haven't been opened from a file are journaled to untitled.journal
+	EditJournal journal;
+	std::vector<JournalSpline> recoveredPath;
+
+	if (journal.open("untitled.journal", recoveredPath) && !recoveredPath.empty()) {
+		splines = fromJournal(recoveredPath);
+		history = {splines};
+	}
+
 	bool fileSelected = false;
 	bool saved = false;
 
+	// Saves run on the writer thread, saved is set once the newest save has reached the disk
+	AsyncFileWriter saveWriter;
+	AsyncFileWriter exportWriter;
+	int exportStride = 1;
+	bool compressExport = false;
+	float exportTolerance[3] = {0.1, 0.5, 0.5};
+	size_t exportedBytes = 0;
+	unsigned long pendingSave = 0;
+
+	PathPlanner::FrameProfiler profiler;
+
+	int heatmapMode = HeatmapNone;
+
+	// Samples placed by how fast the speed limit changes instead of once per inch, within maxTimeError seconds over the
+	// whole path
+	bool adaptiveSampling = false;
+	float maxTimeError = 0.005;
+
+	// Time optimal speeds from reachability analysis instead of the forward and backward passes
+	bool timeOptimal = false;
+
+	// Closed loop run of a follower over the plan every frame, to see how far off the path it ends up
+	bool simulateFollower = false;
+	PathPlanner::TrackingController trackingController = PathPlanner::TrackingController::Ramsete;
+	float followerLatency = 20.0;
+
+	// Control points by position so only the splines near the mouse are hit tested, rebuilt whenever splines are
+	// added, removed or replaced
+	PathPlanner::SpatialGrid controlPoints;
+	std::vector<uint32_t> nearbyPoints;
+	bool controlPointsDirty = true;
+	int focusedSpline = -1;
+
+	// Moves the handles on a worker thread, every faster path it finds replaces the splines until it is stopped or the
+	// path is edited
+	PathPlanner::PathOptimizer optimizer;
+
 	while (!glfwWindowShouldClose(window))
 	{
 		// Poll and handle events (inputs, window resize, etc.)
@@ -418,6 +895,17 @@ int main(int, char**)
 		if (ImGui::IsMouseClicked(0) || ImGui::IsMouseClicked(1)) {
 			// Keep tract of saved status
 			saved = false;
+			pendingSave = 0;
+		}
+
+		if (pendingSave != 0 && saveWriter.getCompletedGeneration() >= pendingSave) {
+			saved = saveWriter.getLastSucceeded();
+			pendingSave = 0;
+
+			// The saved file holds everything now, so compact the journal
+			if (saved) {
+				journal.checkpoint();
+			}
 		}
 
 		// Show saved indicator in field window with an unsaved document flag
@@ -429,202 +917,246 @@ int main(int, char**)
 
 		// When the file is saved we set saved = true;
 
-		ImGui::Image((void*)(intptr_t)my_image_texture, ImVec2(my_image_width, my_image_height));
+		// Every field image is stretched over the 140 inch field no matter its resolution
+		ImGui::Image((void*)(intptr_t)my_image_texture, ImVec2(convertFromField(140.0), convertFromField(140.0)));
 		ImVec2 windowPosition = minus(ImGui::GetWindowPos(), ImVec2(-10.0, -30.0));
 		ImGui::End();
 
+		std::vector<PathPlanner::ControlPoints> optimizedPath;
+		double optimizedTime;
+
+		if (optimizer.takeImprovement(optimizedPath, optimizedTime)) {
+			if (optimizedPath.size() == splines.size()) {
+				applyControlPoints(splines, optimizedPath);
+				controlPointsDirty = true;
+				saved = false;
+			} else {
+				optimizer.stop();
+			}
+		}
+
 		ImGui::Begin("Graphs", NULL);
 		QSpeed maxRobotSpeed = 60_in/second;
 		QAcceleration maxRobotAcceleration = 100_in/second/second;
 		QLength trackWidth = 8_in;
+		QSpeed maxWheelSpeed = 60_in/second;
+		QAcceleration maxWheelAcceleration = 100_in/second/second;
+		QAcceleration maxLateralAcceleration = 100_in/second/second;
+		QLength robotLength = 18_in;
+		QLength robotWidth = 18_in;
 
-		std::vector<PathPlanner::BezierSegment> segments;
+		PathPlanner::VelocityPlanner velocityPlanner({maxRobotSpeed, maxRobotAcceleration, trackWidth, maxWheelSpeed, maxWheelAcceleration, maxLateralAcceleration, true, QTime(adaptiveSampling ? maxTimeError : 0.0), timeOptimal ? PathPlanner::PlannerMethod::Reachability : PathPlanner::PlannerMethod::TwoPass});
 
-		for (auto spline : splines) {
-			segments.emplace_back(spline.getBezierSegment());
-		}
+		std::vector<PathPlanner::BezierSegment> segments;
+		std::vector<bool> inverted;
 
-		QLength length = 0.0;
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Segments");
 
-		std::for_each(segments.begin(), segments.end(), [&](auto &item) {
-			length += item.getDistance();
-		});
+			for (auto spline : splines) {
+				segments.emplace_back(spline.getBezierSegment());
+				inverted.emplace_back(*spline.getInverted());
+			}
+		}
 
-		int granularity = std::max(5.0, length.Convert(1_in));
+		PathPlanner::PlannedPath plannedPath;
 
-		QLength distanceChange = length /(double) granularity;
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Velocity passes");
+			plannedPath = velocityPlanner.calculate(segments, inverted);
+		}
 
-		std::vector<QSpeed> maxSpeedLeft;
-		std::vector<QSpeed> maxSpeedRight;
-		std::vector<QSpeed> maxSpeed;
-		auto* curvatureByDistance = (float*) malloc((granularity +1)*sizeof(float));
-		auto* maxSpeedByDistance = (float*) malloc((granularity+1)*sizeof(float));
-		auto* limitedSpeedLeft = (float*) malloc((granularity+1)*sizeof(float));
-		auto* limitedSpeedRight = (float*) malloc((granularity+1)*sizeof(float));
-		auto* limitedSpeed = (float*) malloc((granularity+1)*sizeof(float));
-		auto* time = (float*) malloc((granularity+1)*sizeof(float));
-		auto* distanceTotal = (float*) malloc((granularity+1)*sizeof(float));
-		auto* accelerationByDistance = (float*) malloc((granularity+1)*sizeof(float));
+		PathPlanner::SimulationResult simulation;
 
-		QSpeed lastSpeed = 0.0;
-		QTime lastTime = 0.0;
+		if (simulateFollower) {
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Simulation");
 
-		for (int i = 0; i <= granularity; i++) {
-			QLength currentDistance = length.getValue() * (static_cast<double>(i) / static_cast<double>(granularity));
-			distanceTotal[i] = currentDistance.Convert(inch);
+			PathPlanner::SimulatorConfig simulatorConfig;
+			simulatorConfig.trackWidth = trackWidth;
+			simulatorConfig.maxWheelSpeed = maxWheelSpeed;
+			simulatorConfig.maxWheelAcceleration = maxWheelAcceleration;
+			simulatorConfig.latency = followerLatency * millisecond;
+			simulatorConfig.controller = trackingController;
 
-			int t = 0;
-			double remainder = 0;
+			simulation = PathPlanner::DriveSimulator(simulatorConfig).simulate(plannedPath);
+		}
 
-			while (t < (segments.size()-1) && currentDistance >= segments.at(t).getDistance()) {
-				currentDistance -= segments.at(t).getDistance();
-				t ++;
-			}
+		int collisions;
 
-			remainder = segments.at(t).getTByLength(currentDistance);
-			QCurvature currentCurvature = segments.at(t).getCurvature(remainder);
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Collision");
+			collisions = obstacleMap.check(plannedPath, robotLength.Convert(inch), robotWidth.Convert(inch), clearance);
+		}
 
-			QSpeed maxSpeedAtT = (*splines[t].getInverted() ? -1 : 1) * maxRobotSpeed /(1.0 + abs(currentCurvature.getValue() * 0.5) * trackWidth.getValue());
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Telemetry");
 
-			QAcceleration currentAcceleration = 0.0;
-			if (i == 0) {
-				limitedSpeedLeft[i] = 0.0;
-			} else {
-				QTime minimumTime = -abs(lastSpeed.getValue()) + sqrt(pow(lastSpeed.getValue(), 2) + 2 * maxRobotAcceleration.getValue() * distanceChange.getValue());
-				minimumTime = minimumTime.getValue() / maxRobotAcceleration.getValue();
+			size_t logRows = telemetryLog.size();
+			float planEnd = plannedPath.duration.Convert(second);
 
-				QSpeed currentMaxSpeed = abs(lastSpeed.getValue()) + maxRobotAcceleration.getValue()*minimumTime.getValue();
+			// Plan time is log time minus logStart
+			float logStart = (alignLog ? telemetryLog.getMotionStart() : 0.0f) - logShift;
 
-				currentMaxSpeed = std::min(currentMaxSpeed.getValue(), abs(maxSpeedAtT.getValue())) * (*splines[t].getInverted() ? -1 : 1);
+			if (logRows != tracedRows || logStart != tracedStart || planEnd != tracedEnd) {
+				logFieldTrace = telemetryLog.getTrace(-INFINITY, INFINITY, 2000, {PathPlanner::TelemetryX, PathPlanner::TelemetryY});
+				logSpeedTrace = telemetryLog.getTrace(logStart, logStart + planEnd, 1000, {PathPlanner::TelemetryVelocity});
 
-				currentAcceleration = (Qsq(currentMaxSpeed) - Qsq(lastSpeed)) / (2 * distanceChange);
-				QTime duration = abs(((currentMaxSpeed - lastSpeed)/currentAcceleration).getValue());
+				for (auto &time : logSpeedTrace.channels[PathPlanner::TelemetryTime]) {
+					time -= logStart;
+				}
 
-				accelerationByDistance[i] = currentAcceleration.Convert(inch/second/second);
-				lastSpeed = currentMaxSpeed;
-				lastTime = duration;
+				tracedRows = logRows;
+				tracedStart = logStart;
+				tracedEnd = planEnd;
 			}
-
-			time[i] = lastTime.Convert(second);
-			limitedSpeedLeft[i] = lastSpeed.Convert(inch/second);
-			curvatureByDistance[i] = currentCurvature.Convert(degree/inch);
-			maxSpeedByDistance[i] = maxSpeedAtT.Convert(inch/second);
 		}
 
-		lastSpeed = 0.0;
+		PathPlanner::CompressionTolerance compressionTolerance{exportTolerance[0] * inch, exportTolerance[1] * inch / second, exportTolerance[2] * degree / inch};
+		PathPlanner::CompressionResult exportCompression;
+		PathPlanner::EmbeddedSize exportSize;
 
-		for (int i = granularity; i >= 0; i--) {
-			QLength currentDistance = length.getValue() * (static_cast<double>(i) / static_cast<double>(granularity));
-
-			int t = 0;
-			double remainder = 0;
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Compression");
+			PathPlanner::EmbeddedExporter exporter = getExporter(PathPlanner::EmbeddedFormat::Float32, exportStride, compressExport, compressionTolerance);
+			exportCompression = exporter.getCompression(plannedPath);
+			exportSize = exporter.getSize(segments.size(), exportCompression.knots.size());
+		}
 
-			while (t < (segments.size()-1) && currentDistance >= segments.at(t).getDistance()) {
-				currentDistance -= segments.at(t).getDistance();
-				t ++;
-			}
+		PathPlanner::ConflictChecker::Conflict conflict;
 
-			remainder = segments.at(t).getTByLength(currentDistance);
-			QCurvature currentCurvature = segments.at(t).getCurvature(remainder);
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Conflicts");
 
-			QSpeed maxSpeedAtT = (*splines[t].getInverted() ? -1 : 1) * maxRobotSpeed /(1.0 + abs(currentCurvature.getValue() * 0.5) * trackWidth.getValue());
+			// Partners only change when one is added, removed or moved in time, the path being edited is checked every
+			// frame
+			if (partnersDirty) {
+				conflictChecker.clearPartners();
 
-			QAcceleration currentAcceleration = 0.0;
+				for (auto &partner : partners) {
+					partner.plannedPath = velocityPlanner.calculate(partner.segments, partner.inverted);
+					conflictChecker.addPartner(partner.plannedPath, partner.startTime, robotLength.Convert(inch), robotWidth.Convert(inch));
+				}
 
-			if (i == granularity) {
-				limitedSpeedRight[i] = 0.0;
-				lastTime = 0.0;
-			} else {
-				QTime minimumTime = -abs(lastSpeed.getValue()) + sqrt(pow(lastSpeed.getValue(), 2) + 2 * maxRobotAcceleration.getValue() * distanceChange.getValue());
-				minimumTime = minimumTime.getValue() / maxRobotAcceleration.getValue();
+				partnersDirty = false;
+			}
 
-				QSpeed currentMaxSpeed = abs(lastSpeed.getValue()) + maxRobotAcceleration.getValue()*minimumTime.getValue();
+			conflict = conflictChecker.check(plannedPath, 0.0, robotLength.Convert(inch), robotWidth.Convert(inch));
+		}
 
-				currentMaxSpeed = std::min(currentMaxSpeed.getValue(), abs(maxSpeedAtT.getValue())) * (*splines[t].getInverted() ? -1 : 1);
+		int granularity = plannedPath.granularity;
+		QLength length = plannedPath.length;
+		QTime lastTime = plannedPath.duration;
+
+		// Plotted in place, each view is checked against the unit its axis is labelled with
+		const float* curvatureByDistance = plannedPath.curvatureByDistance.view(degree/inch);
+		const float* maxSpeedByDistance = plannedPath.maxSpeedByDistance.view(inch/second);
+		const float* limitedSpeedLeft = plannedPath.limitedSpeedLeft.view(inch/second);
+		const float* limitedSpeedRight = plannedPath.limitedSpeedRight.view(inch/second);
+		const float* limitedSpeed = plannedPath.limitedSpeed.view(inch/second);
+		const float* time = plannedPath.time.view(second);
+		const float* distanceTotal = plannedPath.distanceTotal.view(inch);
+		const float* accelerationByDistance = plannedPath.accelerationByDistance.view(inch/second/second);
+		const float* leftWheelSpeed = plannedPath.leftWheelSpeed.view(inch/second);
+		const float* rightWheelSpeed = plannedPath.rightWheelSpeed.view(inch/second);
+		const float* leftWheelAcceleration = plannedPath.leftWheelAcceleration.view(inch/second/second);
+		const float* rightWheelAcceleration = plannedPath.rightWheelAcceleration.view(inch/second/second);
+		const float* lateralAcceleration = plannedPath.lateralAcceleration.view(inch/second/second);
 
-				currentAcceleration = (Qsq(currentMaxSpeed) - Qsq(lastSpeed)) / (2 * distanceChange);
-				QTime duration = abs(((currentMaxSpeed - lastSpeed)/currentAcceleration).getValue());
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Plots");
 
-				lastSpeed = currentMaxSpeed;
-				lastTime = duration;
+			ImPlot::SetNextAxesToFit();
+			if (ImPlot::BeginPlot("Curvature By Distance")) {
+				ImPlot::SetupAxes("inch", "Degree/Inch");
+				ImPlot::PlotLine("Curvature", distanceTotal, curvatureByDistance, granularity + 1);
+				ImPlot::EndPlot();
 			}
 
-			limitedSpeedRight[i] = lastSpeed.Convert(inch/second);
-			if (lastSpeed.Convert(inch/second) < limitedSpeedLeft[i]) {
-				time[i] = lastTime.Convert(second);
-				accelerationByDistance[i] = currentAcceleration.Convert(inch/second/second);
+			ImPlot::SetNextAxesToFit();
+			if (ImPlot::BeginPlot("Curvature By Time")) {
+				ImPlot::SetupAxes("inch", "Degree/Inch");
+				ImPlot::PlotLine("Curvature", time, curvatureByDistance, granularity + 1);
+				ImPlot::EndPlot();
 			}
-			limitedSpeed[i] = std::min(limitedSpeedLeft[i], limitedSpeedRight[i]);
-		}
 
-		lastTime = 0.0;
+			if (ImPlot::BeginPlot("Speed By Distance")) {
+				ImPlot::SetupAxes("inch", "inch/second");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, -maxRobotSpeed.Convert(inch/second)*1.5, maxRobotSpeed.Convert(inch/second)*1.5, ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, length.Convert(inch), ImPlotCond_Always);
+				ImPlot::PlotLine("Max Speed", distanceTotal, maxSpeedByDistance, granularity + 1);
+				ImPlot::PlotLine("Left-limited Speed", distanceTotal, limitedSpeedLeft, granularity + 1);
+				ImPlot::PlotLine("Right-limited Speed", distanceTotal, limitedSpeedRight, granularity + 1);
+				ImPlot::PlotLine("Limited Speed", distanceTotal, limitedSpeed, granularity + 1);
+				ImPlot::EndPlot();
+			}
 
-		for (int i = 0; i <= granularity; i++) {
-			lastTime += time[i];
-			time[i] = lastTime.Convert(second);
-		}
+			if (ImPlot::BeginPlot("Speed By Time")) {
+				ImPlot::SetupAxes("inch", "inch/second");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, -maxRobotSpeed.Convert(inch/second)*1.5, maxRobotSpeed.Convert(inch/second)*1.5, ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Max Speed", time, maxSpeedByDistance, granularity + 1);
+				ImPlot::PlotLine("Left-limited Speed", time, limitedSpeedLeft, granularity + 1);
+				ImPlot::PlotLine("Right-limited Speed", time, limitedSpeedRight, granularity + 1);
+				ImPlot::PlotLine("Limited Speed", time, limitedSpeed, granularity + 1);
+				if (logSpeedTrace.size() > 0) {
+					ImPlot::PlotLine("Logged Speed", logSpeedTrace.get(PathPlanner::TelemetryTime), logSpeedTrace.get(PathPlanner::TelemetryVelocity), logSpeedTrace.size());
+				}
+				ImPlot::EndPlot();
+			}
 
-		ImPlot::SetNextAxesToFit();
-		if (ImPlot::BeginPlot("Curvature By Distance")) {
-			ImPlot::SetupAxes("inch", "Degree/Inch");
-			ImPlot::PlotLine("Curvature", distanceTotal, curvatureByDistance, granularity + 1);
-			ImPlot::EndPlot();
-		}
+			if (simulation.size() > 0 && ImPlot::BeginPlot("Tracking Error By Time")) {
+				ImPlot::SetupAxes("second", "inch, degree");
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, simulation.time.back().Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Cross-track", simulation.time.view(second), simulation.crossTrackError.view(inch), simulation.size());
+				ImPlot::PlotLine("Along-track", simulation.time.view(second), simulation.alongTrackError.view(inch), simulation.size());
+				ImPlot::PlotLine("Heading", simulation.time.view(second), simulation.headingError.view(degree), simulation.size());
+				ImPlot::EndPlot();
+			}
 
-		ImPlot::SetNextAxesToFit();
-		if (ImPlot::BeginPlot("Curvature By Time")) {
-			ImPlot::SetupAxes("inch", "Degree/Inch");
-			ImPlot::PlotLine("Curvature", time, curvatureByDistance, granularity + 1);
-			ImPlot::EndPlot();
-		}
+			if (ImPlot::BeginPlot("Acceleration By Time")) {
+				ImPlot::SetupAxes("inch", "inch/second");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, -maxRobotAcceleration.Convert(inch/second/second)*1.5, maxRobotAcceleration.Convert(inch/second/second)*1.5, ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Max Speed", time, accelerationByDistance, granularity + 1);
+				ImPlot::EndPlot();
+			}
 
-		if (ImPlot::BeginPlot("Speed By Distance")) {
-			ImPlot::SetupAxes("inch", "inch/second");
-			ImPlot::SetupAxisLimits(ImAxis_Y1, -maxRobotSpeed.Convert(inch/second)*1.5, maxRobotSpeed.Convert(inch/second)*1.5, ImPlotCond_Always);
-			ImPlot::SetupAxisLimits(ImAxis_X1, 0, granularity, ImPlotCond_Always);
-			ImPlot::PlotLine("Max Speed", distanceTotal, maxSpeedByDistance, granularity + 1);
-			ImPlot::PlotLine("Left-limited Speed", distanceTotal, limitedSpeedLeft, granularity + 1);
-			ImPlot::PlotLine("Right-limited Speed", distanceTotal, limitedSpeedRight, granularity + 1);
-			ImPlot::PlotLine("Limited Speed", distanceTotal, limitedSpeed, granularity + 1);
-			ImPlot::EndPlot();
-		}
+			if (ImPlot::BeginPlot("Wheel Speed By Time")) {
+				ImPlot::SetupAxes("second", "inch/second");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, -maxWheelSpeed.Convert(inch/second)*1.5, maxWheelSpeed.Convert(inch/second)*1.5, ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Left Wheel", time, leftWheelSpeed, granularity + 1);
+				ImPlot::PlotLine("Right Wheel", time, rightWheelSpeed, granularity + 1);
+				ImPlot::EndPlot();
+			}
 
-		if (ImPlot::BeginPlot("Speed By Time")) {
-			ImPlot::SetupAxes("inch", "inch/second");
-			ImPlot::SetupAxisLimits(ImAxis_Y1, -maxRobotSpeed.Convert(inch/second)*1.5, maxRobotSpeed.Convert(inch/second)*1.5, ImPlotCond_Always);
-			ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
-			ImPlot::PlotLine("Max Speed", time, maxSpeedByDistance, granularity + 1);
-			ImPlot::PlotLine("Left-limited Speed", time, limitedSpeedLeft, granularity + 1);
-			ImPlot::PlotLine("Right-limited Speed", time, limitedSpeedRight, granularity + 1);
-			ImPlot::PlotLine("Limited Speed", time, limitedSpeed, granularity + 1);
-			ImPlot::EndPlot();
-		}
+			if (ImPlot::BeginPlot("Wheel Acceleration By Time")) {
+				ImPlot::SetupAxes("second", "inch/second^2");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, -maxWheelAcceleration.Convert(inch/second/second)*1.5, maxWheelAcceleration.Convert(inch/second/second)*1.5, ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Left Wheel", time, leftWheelAcceleration, granularity + 1);
+				ImPlot::PlotLine("Right Wheel", time, rightWheelAcceleration, granularity + 1);
+				ImPlot::EndPlot();
+			}
 
-		if (ImPlot::BeginPlot("Acceleration By Time")) {
-			ImPlot::SetupAxes("inch", "inch/second");
-			ImPlot::SetupAxisLimits(ImAxis_Y1, -maxRobotAcceleration.Convert(inch/second/second)*1.5, maxRobotAcceleration.Convert(inch/second/second)*1.5, ImPlotCond_Always);
-			ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
-			ImPlot::PlotLine("Max Speed", time, accelerationByDistance, granularity + 1);
-			ImPlot::EndPlot();
-		}
+			if (ImPlot::BeginPlot("Lateral Acceleration By Time")) {
+				ImPlot::SetupAxes("second", "inch/second^2");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, -maxLateralAcceleration.Convert(inch/second/second)*1.5, maxLateralAcceleration.Convert(inch/second/second)*1.5, ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Lateral", time, lateralAcceleration, granularity + 1);
+				ImPlot::PlotLine("Tangential", time, accelerationByDistance, granularity + 1);
+				ImPlot::EndPlot();
+			}
 
-		if (ImPlot::BeginPlot("Distance By Time")) {
-			ImPlot::SetupAxes("inch", "inch/second");
-			ImPlot::SetupAxisLimits(ImAxis_Y1, 0, length.Convert(inch), ImPlotCond_Always);
-			ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
-			ImPlot::PlotLine("Max Speed", time, distanceTotal, granularity + 1);
-			ImPlot::EndPlot();
+			if (ImPlot::BeginPlot("Distance By Time")) {
+				ImPlot::SetupAxes("inch", "inch/second");
+				ImPlot::SetupAxisLimits(ImAxis_Y1, 0, length.Convert(inch), ImPlotCond_Always);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, lastTime.Convert(second), ImPlotCond_Always);
+				ImPlot::PlotLine("Max Speed", time, distanceTotal, granularity + 1);
+				ImPlot::EndPlot();
+			}
 		}
 
-		free(curvatureByDistance);
-		free(maxSpeedByDistance);
-		free(limitedSpeedLeft);
-		free(limitedSpeedRight);
-		free(limitedSpeed);
-		free(time);
-		free(distanceTotal);
-		free(accelerationByDistance);
-
 		ImGui::End();
 
 		// display
@@ -633,7 +1165,16 @@ int main(int, char**)
 			// action if OK
 			if (ImGuiFileDialog::Instance()->IsOk())
 			{
+				optimizer.stop();
 				open(ImGuiFileDialog::Instance()->GetFilePathName(), &splines);
+
+				// Replay edits to this file that were lost in a crash, the journal of the previous path isn't needed
+				journal.close(true);
+				if (journal.open(ImGuiFileDialog::Instance()->GetFilePathName() + ".journal", recoveredPath) && !recoveredPath.empty()) {
+					splines = fromJournal(recoveredPath);
+				}
+
+				controlPointsDirty = true;
 				fileSelected = true;
 				// action
 			}
@@ -642,6 +1183,27 @@ int main(int, char**)
 			ImGuiFileDialog::Instance()->Close();
 		}
 
+		if (ImGuiFileDialog::Instance()->Display("ChoosePartnerDlgKey"))
+		{
+			PartnerPath partner;
+
+			if (ImGuiFileDialog::Instance()->IsOk() && openPartner(ImGuiFileDialog::Instance()->GetFilePathName(), partner)) {
+				partners.emplace_back(std::move(partner));
+				partnersDirty = true;
+			}
+
+			ImGuiFileDialog::Instance()->Close();
+		}
+
+		if (ImGuiFileDialog::Instance()->Display("ChooseLogDlgKey"))
+		{
+			if (ImGuiFileDialog::Instance()->IsOk()) {
+				telemetryLog.load(ImGuiFileDialog::Instance()->GetFilePathName());
+			}
+
+			ImGuiFileDialog::Instance()->Close();
+		}
+
 		ImGui::Begin(
 				"FileWindow!", NULL, ImGuiWindowFlags_MenuBar);                          // Create a window called "Hello, world!" and append into it.
 
@@ -652,19 +1214,26 @@ int main(int, char**)
 				if (ImGui::MenuItem("Open", "Ctrl+O")) { ImGuiFileDialog::Instance()->OpenDialog("ChooseFileDlgKey", "Choose File", ".hpp", "include/AutoPaths/");
 					history.clear();
 					history.emplace_back(splines); }
-				if (ImGui::MenuItem("Save", "Ctrl+S") && fileSelected)   { save(splines, ImGuiFileDialog::Instance()->GetFilePathName(), pathName); saved = true; }
-				if (ImGui::MenuItem("Undo", "Ctrl+Z") && history.size() > 1)   { saved = false; splines = history.at(history.size()-1); history.pop_back(); }
+				if (ImGui::MenuItem("Save", "Ctrl+S") && fileSelected)   { pendingSave = save(saveWriter, splines, ImGuiFileDialog::Instance()->GetFilePathName(), pathName); }
+				if (ImGui::MenuItem("Export float32", NULL, false, fileSelected)) { exportedBytes = exportEmbedded(exportWriter, PathPlanner::EmbeddedFormat::Float32, getExporter(PathPlanner::EmbeddedFormat::Float32, exportStride, compressExport, compressionTolerance), segments, inverted, plannedPath, ImGuiFileDialog::Instance()->GetFilePathName(), pathName).getFlashBytes(); }
+				if (ImGui::MenuItem("Export Q16.16", NULL, false, fileSelected)) { exportedBytes = exportEmbedded(exportWriter, PathPlanner::EmbeddedFormat::Fixed16, getExporter(PathPlanner::EmbeddedFormat::Fixed16, exportStride, compressExport, compressionTolerance), segments, inverted, plannedPath, ImGuiFileDialog::Instance()->GetFilePathName(), pathName).getFlashBytes(); }
+				if (ImGui::MenuItem("Undo", "Ctrl+Z") && history.size() > 1)   { optimizer.stop(); saved = false; splines = history.at(history.size()-1); history.pop_back(); controlPointsDirty = true; }
 				ImGui::EndMenu();
 			}
 			ImGui::EndMenuBar();
 		}
 
-		if (ImGui::GetKeyPressedAmount(ImGuiKey_S, 1, 0.05) == 1 && !ImGui::IsAnyItemActive() && fileSelected) {
-			save(splines, ImGuiFileDialog::Instance()->GetFilePathName(), pathName); saved = true;
+		if (ImGui::IsKeyPressed(ImGuiKey_S, false) && !ImGui::IsAnyItemActive() && fileSelected) {
+			pendingSave = save(saveWriter, splines, ImGuiFileDialog::Instance()->GetFilePathName(), pathName);
 		}
 
 		if (ImGui::GetKeyPressedAmount(ImGuiKey_Z, 1, 0.05) == 1 && !ImGui::IsAnyItemActive() && history.size() > 1) {
-			saved = false; splines = history.at(history.size()-1); history.pop_back();
+			optimizer.stop();
+			saved = false; splines = history.at(history.size()-1); history.pop_back(); controlPointsDirty = true;
+		}
+
+		if (ImGui::IsKeyPressed(ImGuiKey_F12, false)) {
+			profiler.dump("profile_capture_" + std::to_string(ImGui::GetFrameCount()) + ".csv");
 		}
 
 		if (ImGui::GetKeyPressedAmount(ImGuiKey_O, 1, 0.05) == 1 && !ImGui::IsAnyItemActive()) {
@@ -672,10 +1241,95 @@ int main(int, char**)
 			history.clear();
 			history.emplace_back(splines);
 		}
-		ImGui::Text("X: %f, Y: %f", (ImGui::GetMousePos().y-windowPosition.y) / my_image_width * 140.0,
-					(ImGui::GetMousePos().x-windowPosition.x) / my_image_height * 140.0);
+		ImGui::Text("X: %f, Y: %f", convertToField(ImGui::GetMousePos().y-windowPosition.y),
+					convertToField(ImGui::GetMousePos().x-windowPosition.x));
+
+		if (ImGui::BeginCombo("Field", fieldImages.empty() ? "" : fieldImages.at(fieldImageIndex).c_str())) {
+			for (int i = 0; i < fieldImages.size(); i++) {
+				if (ImGui::Selectable(fieldImages.at(i).c_str(), i == fieldImageIndex) && i != fieldImageIndex) {
+					GLuint newTexture = 0;
+
+					if (LoadTextureFromFile(fieldImages.at(i).c_str(), &newTexture, &my_image_width, &my_image_height)) {
+						glDeleteTextures(1, &my_image_texture);
+						my_image_texture = newTexture;
+						fieldImageIndex = i;
+
+						loadObstacles(obstacleMap, fieldImages.at(i));
+					}
+				}
+			}
+			ImGui::EndCombo();
+		}
+
+		ImGui::Text("Partner paths: ");
+
+		for (int i = 0; i < partners.size(); i++) {
+			ImGui::PushID(i);
+			ImGui::Text("%s", partners.at(i).filename.c_str());
+			partnersDirty = ImGui::DragFloat("Start time", &partners.at(i).startTime, 0.05, 0.0, 15.0, "%.2f s") || partnersDirty;
+			ImGui::SameLine();
+			if (ImGui::Button("Remove")) {
+				partners.erase(partners.begin() + i);
+				partnersDirty = true;
+				ImGui::PopID();
+				break;
+			}
+			ImGui::PopID();
+		}
+
+		if (ImGui::Button("Add partner path")) {
+			ImGuiFileDialog::Instance()->OpenDialog("ChoosePartnerDlgKey", "Choose Partner Path", ".hpp", ".");
+		}
+
+		if (telemetryLog.getStatus() != PathPlanner::TelemetryLog::Empty) {
+			ImGui::Text("Telemetry log: %s, %zu rows", telemetryLog.getFilename().c_str(), telemetryLog.size());
+
+			if (telemetryLog.getStatus() == PathPlanner::TelemetryLog::Loading) {
+				ImGui::ProgressBar(telemetryLog.getProgress());
+			} else if (telemetryLog.getStatus() == PathPlanner::TelemetryLog::Failed) {
+				ImGui::TextColored(ImVec4(0.9, 0.1, 0.1, 1.0), "Couldn't read any rows with a time, x and y");
+			}
+
+			ImGui::Checkbox("Align log to motion start", &alignLog);
+			ImGui::DragFloat("Log time shift", &logShift, 0.01, -15.0, 15.0, "%.2f s");
+			if (ImGui::Button("Close log")) {
+				telemetryLog.close();
+			}
+			ImGui::SameLine();
+		}
+
+		if (ImGui::Button("Open telemetry log")) {
+			ImGuiFileDialog::Instance()->OpenDialog("ChooseLogDlgKey", "Choose Telemetry Log", ".csv,.bin", ".");
+		}
+
+		if (conflict.found) {
+			ImGui::TextColored(ImVec4(0.9, 0.1, 0.1, 1.0), "Hits partner %d at %.2f s, X: %.1f, Y: %.1f", conflict.partner, conflict.time, conflict.x, conflict.y);
+		} else if (!partners.empty()) {
+			ImGui::Text("No conflicts with partners");
+		}
 
 		ImGui::InputText("Name", &pathName);
+
+		// Sizes on the robot, updated live so the path can be kept inside the flash budget while it is edited
+		ImGui::Checkbox("Compress exported profile", &compressExport);
+		if (compressExport) {
+			ImGui::InputFloat("Max distance error", &exportTolerance[0], 0.0f, 0.0f, "%.3f in");
+			ImGui::InputFloat("Max velocity error", &exportTolerance[1], 0.0f, 0.0f, "%.3f in/s");
+			ImGui::InputFloat("Max curvature error", &exportTolerance[2], 0.0f, 0.0f, "%.3f deg/in");
+			for (auto &tolerance : exportTolerance) {
+				tolerance = std::max(0.0f, tolerance);
+			}
+		} else {
+			ImGui::InputInt("Export every n samples", &exportStride);
+			exportStride = std::max(1, exportStride);
+		}
+		ImGui::Text("Embedded size: %zu bytes", exportSize.getFlashBytes());
+		ImGui::Text("Profile: %zu of %d samples (%.1fx), worst error %.3f in, %.3f in/s, %.3f deg/in", exportCompression.knots.size(), exportCompression.originalSamples,
+					exportCompression.getRatio(), exportCompression.maxDistanceError.Convert(inch), exportCompression.maxVelocityError.Convert(inch/second), exportCompression.maxCurvatureError.Convert(degree/inch));
+		if (exportedBytes > 0) {
+			ImGui::SameLine();
+			ImGui::Text("(last export %zu bytes)", exportedBytes);
+		}
 		ImGui::Text("History length: %ld", history.size());
 
 		ImGui::Text("Inverted: ");
@@ -700,17 +1354,148 @@ int main(int, char**)
 			ImGui::InputText(("mp: " + std::to_string(i)).c_str(), splines.at(i).getMPPointer());
 		}
 
+		ImGui::Text("Path coloring: ");
+		ImGui::RadioButton("Single color", &heatmapMode, HeatmapNone);
+		ImGui::SameLine();
+		ImGui::RadioButton("Speed", &heatmapMode, HeatmapSpeed);
+		ImGui::SameLine();
+		ImGui::RadioButton("Curvature", &heatmapMode, HeatmapCurvature);
+
+		if (collisions > 0) {
+			ImGui::TextColored(ImVec4(0.9, 0.1, 0.1, 1.0), "Robot hits obstacles at %d samples, %.1f in deep", collisions, -*std::min_element(clearance.begin(), clearance.end()));
+		} else {
+			ImGui::Text("No collisions, closest %.1f in", clearance.empty() ? 0.0f : *std::min_element(clearance.begin(), clearance.end()));
+		}
+
+		if (optimizer.isRunning()) {
+			if (ImGui::Button("Stop optimizing")) {
+				optimizer.stop();
+			}
+		} else if (ImGui::Button("Optimize")) {
+			history.emplace_back(splines);
+			if (history.size() > 30) {
+				history.erase(history.begin());
+			}
+
+			optimizer.start(toControlPoints(splines), inverted, velocityPlanner.getConstraints());
+		}
+		ImGui::SameLine();
+		ImGui::Text("Path time: %.3f s", lastTime.Convert(second));
+
+		if (ImGui::Button("Smooth path")) {
+			history.emplace_back(splines);
+			if (history.size() > 30) {
+				history.erase(history.begin());
+			}
+
+			optimizer.stop();
+
+			std::vector<PathPlanner::ControlPoints> smoothedPath = toControlPoints(splines);
+			PathPlanner::smoothPath(smoothedPath, inverted);
+			applyControlPoints(splines, smoothedPath);
+			controlPointsDirty = true;
+			saved = false;
+		}
+		ImGui::SameLine();
+		ImGui::Checkbox("Smooth while dragging", &smoothWhileDragging);
+
+		ImGui::Checkbox("Adaptive sampling", &adaptiveSampling);
+		if (adaptiveSampling) {
+			ImGui::SameLine();
+			ImGui::InputFloat("Max time error", &maxTimeError, 0.0f, 0.0f, "%.4f s");
+			maxTimeError = std::max(0.0001f, maxTimeError);
+
+			if (!plannedPath.withinTimeError) {
+				ImGui::TextColored(ImVec4(0.9, 0.1, 0.1, 1.0), "Samples are as close as they go, the time can be off by more than this");
+			}
+		}
+		ImGui::Checkbox("Time optimal speeds", &timeOptimal);
+
+		ImGui::Checkbox("Simulate follower", &simulateFollower);
+		if (simulateFollower) {
+			ImGui::SameLine();
+			if (ImGui::RadioButton("RAMSETE", trackingController == PathPlanner::TrackingController::Ramsete)) {
+				trackingController = PathPlanner::TrackingController::Ramsete;
+			}
+			ImGui::SameLine();
+			if (ImGui::RadioButton("Pure pursuit", trackingController == PathPlanner::TrackingController::PurePursuit)) {
+				trackingController = PathPlanner::TrackingController::PurePursuit;
+			}
+			ImGui::InputFloat("Follower latency", &followerLatency, 0.0f, 0.0f, "%.0f ms");
+			followerLatency = std::max(0.0f, followerLatency);
+			ImGui::Text("Max cross-track %.2f in, rms %.2f in, max heading %.1f deg, ends %.2f in off",
+						simulation.maxCrossTrackError.Convert(inch), simulation.rmsCrossTrackError.Convert(inch),
+						simulation.maxHeadingError.Convert(degree), simulation.finalError.Convert(inch));
+		}
+		ImGui::Text("Planner samples: %d", plannedPath.size());
+
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
 		ImGui::End();
 
 		bool isFocus = false;
 
-		for (auto &item: splines) {
-			isFocus = item.processMouse(windowPosition, isFocus) || isFocus;
+		ImVec2 fieldMousePosition = minus(ImGui::GetMousePos(), windowPosition);
+
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "processMouse");
+
+			if (controlPointsDirty) {
+				rebuildControlPoints(controlPoints, splines);
+				controlPointsDirty = false;
+
+				// Splines restored from the history can still have a point in focus, keep processing it until the mouse
+				// comes up
+				focusedSpline = -1;
+				for (int i = 0; i < splines.size() && focusedSpline < 0; i++) {
+					if (splines.at(i).hasFocus()) {
+						focusedSpline = i;
+					}
+				}
+			}
+
+			// Only the splines with a point under the mouse or a point being dragged can change, processed in path order
+			// so points sooner in the path keep priority
+			controlPoints.query(fieldMousePosition.x, fieldMousePosition.y, 8, nearbyPoints);
+
+			std::vector<int> candidates;
+			for (auto &id : nearbyPoints) {
+				candidates.emplace_back(id / 4);
+			}
+			if (focusedSpline >= 0) {
+				candidates.emplace_back(focusedSpline);
+			}
+
+			std::sort(candidates.begin(), candidates.end());
+			candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+			focusedSpline = -1;
+
+			for (auto &i : candidates) {
+				isFocus = splines.at(i).processMouse(windowPosition, isFocus) || isFocus;
+
+				if (splines.at(i).hasFocus()) {
+					focusedSpline = i;
+
+					for (int point = 0; point < 4; point++) {
+						controlPoints.update(i * 4 + point, splines.at(i).get(point).x, splines.at(i).get(point).y);
+					}
+				}
+			}
+
+			// The handles follow the endpoints being dragged, every handle can move so the whole grid is rebuilt
+			if (smoothWhileDragging && focusedSpline >= 0) {
+				std::vector<PathPlanner::ControlPoints> smoothedPath = toControlPoints(splines);
+				PathPlanner::smoothPath(smoothedPath, inverted);
+				applyControlPoints(splines, smoothedPath);
+				controlPointsDirty = true;
+			}
 		}
 
 		// Determines if something has changed
 		if (isFocus && ImGui::IsMouseClicked(0)) {
+			// Editing the path by hand takes over from the optimizer
+			optimizer.stop();
+
 			// Add a new splines array to the history
 			history.emplace_back(splines);
 
@@ -721,16 +1506,25 @@ int main(int, char**)
 		}
 
 		if (ImGui::IsMouseDoubleClicked(1) && splines.size() > 1) {
-			for (int i = 0; i < splines.size(); i++) {
-				if (distance(splines.at(i).get(3), minus(ImGui::GetMousePos(), windowPosition)) < 8) {
-					history.emplace_back(splines);
-					if (history.size() > 30) {
-						history.erase(history.begin());
-					}
+			// Delete the first spline that ends under the mouse
+			controlPoints.query(fieldMousePosition.x, fieldMousePosition.y, 8, nearbyPoints);
+
+			int deleted = -1;
+			for (auto &id : nearbyPoints) {
+				if (id % 4 == 3 && distance(splines.at(id / 4).get(3), fieldMousePosition) < 8 && (deleted < 0 || id / 4 < deleted)) {
+					deleted = id / 4;
+				}
+			}
 
-					splines.erase(splines.begin() + i);
-					break;
+			if (deleted >= 0) {
+				history.emplace_back(splines);
+				if (history.size() > 30) {
+					history.erase(history.begin());
 				}
+
+				optimizer.stop();
+				splines.erase(splines.begin() + deleted);
+				controlPointsDirty = true;
 			}
 		}
 
@@ -739,21 +1533,56 @@ int main(int, char**)
 			if (history.size() > 30) {
 				history.erase(history.begin());
 			}
+			optimizer.stop();
 			splines.emplace_back(splines.at(splines.size()-1).get(3), splines.at(splines.size()-1).get(2), minus(ImGui::GetMousePos(), windowPosition));
+			controlPointsDirty = true;
 		}
 
-		for (auto &item: splines) {
-			item.printSpline(windowPosition);
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Journal");
+			journal.record(toJournal(splines));
 		}
 
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Spline drawing");
+
+			std::vector<bool> displayed;
+			for (auto &item: splines) {
+				displayed.emplace_back(*item.getDisplayed());
+			}
+
+			if (heatmapMode == HeatmapSpeed) {
+				drawHeatmap(ImGui::GetForegroundDrawList(), plannedPath, plannedPath.limitedSpeed.view(inch/second), segments, displayed, windowPosition);
+			} else if (heatmapMode == HeatmapCurvature) {
+				drawHeatmap(ImGui::GetForegroundDrawList(), plannedPath, plannedPath.curvatureByDistance.view(degree/inch), segments, displayed, windowPosition);
+			}
+
+			for (auto &item: splines) {
+				item.printSpline(windowPosition, heatmapMode == HeatmapNone);
+			}
+
+			drawCollisions(ImGui::GetForegroundDrawList(), plannedPath, clearance, robotLength.Convert(inch), robotWidth.Convert(inch), windowPosition);
+			drawPartners(ImGui::GetForegroundDrawList(), partners, conflict, robotLength.Convert(inch), windowPosition);
+			drawTelemetry(ImGui::GetForegroundDrawList(), logFieldTrace, windowPosition);
+			drawSimulation(ImGui::GetForegroundDrawList(), simulation, windowPosition);
+		}
+
+		drawProfiler(profiler);
+
 		// Rendering
-		ImGui::Render();
-		int display_w, display_h;
-		glfwGetFramebufferSize(window, &display_w, &display_h);
-		glViewport(0, 0, display_w, display_h);
-		glClearColor(clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w);
-		glClear(GL_COLOR_BUFFER_BIT);
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		{
+			PathPlanner::FrameProfiler::ScopedTimer timer(profiler, "Rendering");
+
+			ImGui::Render();
+			int display_w, display_h;
+			glfwGetFramebufferSize(window, &display_w, &display_h);
+			glViewport(0, 0, display_w, display_h);
+			glClearColor(clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w);
+			glClear(GL_COLOR_BUFFER_BIT);
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		}
+
+		profiler.endFrame();
 
 		glfwSwapBuffers(window);
 	}
@@ -761,6 +1590,9 @@ int main(int, char**)
 	EMSCRIPTEN_MAINLOOP_END;
 #endif
 
+	// Clean exit, nothing to recover next time
+	journal.close(true);
+
 	// Cleanup
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "velocityPlanner.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Field elements the robot can't drive through, stored as a signed distance field
+	 *
+	 * Obstacles are polygons in field inches and masks drawn over the field image. Both are rasterized into a grid and
+	 * turned into the distance to the nearest obstacle edge, negative inside an obstacle, so checking the robot against
+	 * every obstacle is a few lookups per sample no matter how many obstacles there are. The field walls are always
+	 * obstacles and are measured exactly instead of through the grid.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class ObstacleMap {
+	public:
+		typedef std::vector<std::pair<float, float>> Polygon;
+
+	private:
+		static constexpr float infinity = 1.0e20;
+
+		// Paths with more samples than this are checked on every core
+		static constexpr int parallelSamples = 4096;
+
+		// Largest cell the footprint is split into near an obstacle, in inches
+		static constexpr float footprintSpacing = 1.0;
+
+		float fieldSize;
+		float resolution;
+		int cells;
+
+		std::vector<Polygon> polygons;
+		std::vector<uint8_t> occupied;
+		std::vector<float> distance;
+
+		bool hasObstacles{false};
+
+		/**
+		 * @brief Squared distance to the nearest zero of f along one line, Felzenszwalb and Huttenlocher's lower
+		 * envelope of parabolas
+		 */
+		static void distanceTransform(const float* f, float* result, int n, int stride, std::vector<int>& v, std::vector<double>& z) {
+			auto intersection = [&](int q, int p) {
+				return ((f[q * stride] + (double) q * q) - (f[p * stride] + (double) p * p)) / (2.0 * (q - p));
+			};
+
+			int k = 0;
+			v[0] = 0;
+			z[0] = -infinity;
+			z[1] = infinity;
+
+			for (int q = 1; q < n; q++) {
+				double s = intersection(q, v[k]);
+
+				while (s <= z[k]) {
+					k--;
+					s = intersection(q, v[k]);
+				}
+
+				k++;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = infinity;
+			}
+
+			k = 0;
+
+			for (int q = 0; q < n; q++) {
+				while (z[k + 1] < q) {
+					k++;
+				}
+
+				result[q * stride] = (float) ((q - v[k]) * (q - v[k]) + f[v[k] * stride]);
+			}
+		}
+
+		/**
+		 * @brief Distance in cells from every cell to the nearest cell where the grid is set to want
+		 */
+		std::vector<float> distanceTo(uint8_t want) const {
+			std::vector<float> grid(cells * cells);
+			std::vector<float> column(cells * cells);
+			std::vector<int> v(cells);
+			std::vector<double> z(cells + 1);
+
+			for (int i = 0; i < cells * cells; i++) {
+				grid[i] = occupied[i] == want ? 0.0f : infinity;
+			}
+
+			for (int x = 0; x < cells; x++) {
+				distanceTransform(&grid[x], &column[x], cells, cells, v, z);
+			}
+
+			for (int y = 0; y < cells; y++) {
+				distanceTransform(&column[y * cells], &grid[y * cells], cells, 1, v, z);
+			}
+
+			for (auto &value : grid) {
+				value = sqrt(value);
+			}
+
+			return grid;
+		}
+
+		static bool insidePolygon(const Polygon& polygon, float x, float y) {
+			bool inside = false;
+
+			for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+				float xi = polygon[i].first, yi = polygon[i].second;
+				float xj = polygon[j].first, yj = polygon[j].second;
+
+				if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi) {
+					inside = !inside;
+				}
+			}
+
+			return inside;
+		}
+
+		float getGridDistance(float x, float y) const {
+			if (!hasObstacles) {
+				return infinity;
+			}
+
+			// Values are at cell centers
+			float gx = std::clamp(x / resolution - 0.5f, 0.0f, (float) cells - 1.0f);
+			float gy = std::clamp(y / resolution - 0.5f, 0.0f, (float) cells - 1.0f);
+
+			int x0 = std::min((int) gx, cells - 2);
+			int y0 = std::min((int) gy, cells - 2);
+			float fx = gx - x0;
+			float fy = gy - y0;
+
+			float a = distance[y0 * cells + x0] * (1.0f - fx) + distance[y0 * cells + x0 + 1] * fx;
+			float b = distance[(y0 + 1) * cells + x0] * (1.0f - fx) + distance[(y0 + 1) * cells + x0 + 1] * fx;
+
+			return a * (1.0f - fy) + b * fy;
+		}
+
+		float getWallDistance(float x, float y) const {
+			return std::min(std::min(x, fieldSize - x), std::min(y, fieldSize - y));
+		}
+
+		/**
+		 * @brief Free space around the robot at every sample in a range, facing along the path
+		 *
+		 * The walls are straight, so the corner of the robot closest to one is the closest point of the robot and the
+		 * wall clearance is exact. For the grid the footprint is split into cells about footprintSpacing across, and a
+		 * circle through the corners of a cell covers it, so each cell needs only half its diagonal of free space.
+		 * Samples far from every obstacle skip the cells, the distance at the center is enough.
+		 */
+		void checkRange(const PlannedPath& path, float robotLength, float robotWidth, std::vector<float>& clearance, int start, int end) const {
+			int lengthCells = std::max(1, (int) ceil(robotLength / footprintSpacing));
+			int widthCells = std::max(1, (int) ceil(robotWidth / footprintSpacing));
+			float cellLength = robotLength / lengthCells;
+			float cellWidth = robotWidth / widthCells;
+			float cellRadius = 0.5f * sqrt(cellLength * cellLength + cellWidth * cellWidth);
+			float halfDiagonal = 0.5f * sqrt(robotLength * robotLength + robotWidth * robotWidth);
+
+			// The positions are checked in inches as they are stored
+			const float* positionX = path.positionX.view(inch);
+			const float* positionY = path.positionY.view(inch);
+
+			for (int i = start; i < end; i++) {
+				int before = std::max(0, i - 1);
+				int after = std::min(path.size() - 1, i + 1);
+
+				float dx = positionX[after] - positionX[before];
+				float dy = positionY[after] - positionY[before];
+				float length = sqrt(dx * dx + dy * dy);
+
+				if (length > 0.0f) {
+					dx /= length;
+					dy /= length;
+				} else {
+					dx = 1.0f;
+					dy = 0.0f;
+				}
+
+				// A point along and across the robot from its center
+				auto getPoint = [&](float along, float across) {
+					return std::make_pair(positionX[i] + dx * along - dy * across, positionY[i] + dy * along + dx * across);
+				};
+
+				float result = infinity;
+
+				for (float along : {-0.5f * robotLength, 0.5f * robotLength}) {
+					for (float across : {-0.5f * robotWidth, 0.5f * robotWidth}) {
+						auto [x, y] = getPoint(along, across);
+						result = std::min(result, getWallDistance(x, y));
+					}
+				}
+
+				if (hasObstacles) {
+					float centerDistance = getGridDistance(positionX[i], positionY[i]) - halfDiagonal;
+
+					if (centerDistance >= 0.0f) {
+						result = std::min(result, centerDistance);
+					} else {
+						for (int lengthCell = 0; lengthCell < lengthCells; lengthCell++) {
+							for (int widthCell = 0; widthCell < widthCells; widthCell++) {
+								auto [x, y] = getPoint(-0.5f * robotLength + cellLength * (lengthCell + 0.5f), -0.5f * robotWidth + cellWidth * (widthCell + 0.5f));
+								result = std::min(result, getGridDistance(x, y) - cellRadius);
+							}
+						}
+					}
+				}
+
+				clearance[i] = result;
+			}
+		}
+
+	public:
+		/**
+		 * @brief Construct a new Obstacle Map
+		 *
+		 * @param fieldSize Width of the square field in inches
+		 * @param resolution Width of a grid cell in inches
+		 */
+		explicit ObstacleMap(float fieldSize = 140.0, float resolution = 0.5) : fieldSize(fieldSize), resolution(resolution) {
+			cells = std::max(2, (int) ceil(fieldSize / resolution));
+			occupied.assign(cells * cells, 0);
+		}
+
+		void clear() {
+			polygons.clear();
+			occupied.assign(cells * cells, 0);
+			distance.clear();
+			hasObstacles = false;
+		}
+
+		/**
+		 * @brief Add a polygon in field inches, call build() after adding everything
+		 */
+		void addPolygon(Polygon polygon) {
+			if (polygon.size() >= 3) {
+				polygons.emplace_back(std::move(polygon));
+			}
+		}
+
+		/**
+		 * @brief Read polygons from a file, one per line as "x1 y1 x2 y2 x3 y3 ..." in field inches, # starts a comment
+		 *
+		 * @return bool Whether the file could be opened
+		 */
+		bool loadPolygons(const std::string& filename) {
+			std::ifstream file(filename);
+			if (!file) {
+				return false;
+			}
+
+			std::string line;
+
+			while (getline(file, line)) {
+				std::istringstream values(line.substr(0, line.find('#')));
+				Polygon polygon;
+				float x, y;
+
+				while (values >> x >> y) {
+					polygon.emplace_back(x, y);
+				}
+
+				addPolygon(polygon);
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Mark everything under the opaque pixels of a mask as an obstacle, the mask is stretched over the field
+		 * the same way the field image is
+		 *
+		 * @param rgba Pixels of the mask, 4 bytes per pixel
+		 * @param width Width of the mask
+		 * @param height Height of the mask
+		 */
+		void addMask(const unsigned char* rgba, int width, int height) {
+			for (int y = 0; y < cells; y++) {
+				for (int x = 0; x < cells; x++) {
+					// Field x runs down the image and field y across it
+					int row = std::min(height - 1, (int) ((x + 0.5f) * resolution / fieldSize * height));
+					int column = std::min(width - 1, (int) ((y + 0.5f) * resolution / fieldSize * width));
+
+					if (rgba[((size_t) row * width + column) * 4 + 3] >= 128) {
+						occupied[y * cells + x] = 1;
+					}
+				}
+			}
+		}
+
+		/**
+		 * @brief Rasterize the polygons and compute the distance field
+		 */
+		void build() {
+			for (auto &polygon : polygons) {
+				float minX = fieldSize, minY = fieldSize, maxX = 0.0, maxY = 0.0;
+
+				for (auto &point : polygon) {
+					minX = std::min(minX, point.first);
+					maxX = std::max(maxX, point.first);
+					minY = std::min(minY, point.second);
+					maxY = std::max(maxY, point.second);
+				}
+
+				int startX = std::max(0, (int) floor(minX / resolution));
+				int endX = std::min(cells - 1, (int) ceil(maxX / resolution));
+				int startY = std::max(0, (int) floor(minY / resolution));
+				int endY = std::min(cells - 1, (int) ceil(maxY / resolution));
+
+				for (int y = startY; y <= endY; y++) {
+					for (int x = startX; x <= endX; x++) {
+						if (insidePolygon(polygon, (x + 0.5f) * resolution, (y + 0.5f) * resolution)) {
+							occupied[y * cells + x] = 1;
+						}
+					}
+				}
+			}
+
+			hasObstacles = std::find(occupied.begin(), occupied.end(), 1) != occupied.end();
+
+			if (!hasObstacles) {
+				distance.clear();
+				return;
+			}
+
+			std::vector<float> outside = distanceTo(1);
+			std::vector<float> inside = distanceTo(0);
+
+			distance.resize(cells * cells);
+
+			// Distances are between cell centers, the obstacle edge is half a cell closer than the nearest cell
+			for (int i = 0; i < cells * cells; i++) {
+				distance[i] = occupied[i] ? -(inside[i] - 0.5f) * resolution : (outside[i] - 0.5f) * resolution;
+			}
+		}
+
+		/**
+		 * @brief Signed distance in inches from a point to the nearest obstacle or wall, negative inside
+		 */
+		float getDistance(float x, float y) const {
+			return std::min(getWallDistance(x, y), getGridDistance(x, y));
+		}
+
+		/**
+		 * @brief Check a rectangular robot along a planned path, facing along the path at every sample
+		 *
+		 * @param path The planned path
+		 * @param robotLength Length of the robot along its direction of travel in inches
+		 * @param robotWidth Width of the robot in inches
+		 * @param clearance Set to the free space around the robot at every sample, negative where it hits something
+		 * @return int Number of samples where the robot hits something
+		 */
+		int check(const PlannedPath& path, float robotLength, float robotWidth, std::vector<float>& clearance) const {
+			int samples = path.positionX.size();
+			clearance.resize(samples);
+
+			int threads = samples > parallelSamples ? std::max(1u, std::thread::hardware_concurrency()) : 1;
+
+			if (threads == 1) {
+				checkRange(path, robotLength, robotWidth, clearance, 0, samples);
+			} else {
+				std::vector<std::thread> workers;
+				int chunk = (samples + threads - 1) / threads;
+
+				for (int start = 0; start < samples; start += chunk) {
+					workers.emplace_back(&ObstacleMap::checkRange, this, std::cref(path), robotLength, robotWidth, std::ref(clearance), start, std::min(samples, start + chunk));
+				}
+
+				for (auto &worker : workers) {
+					worker.join();
+				}
+			}
+
+			return std::count_if(clearance.begin(), clearance.end(), [](float value) { return value < 0.0f; });
+		}
+	};
+} // namespace PathPlanner
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PathPlanner {
+
+	/**
+	 * @brief One spline read from a path file, points are in field inches
+	 */
+	struct PathFileSpline {
+		float points[4][2];
+		bool inverted;
+		std::string motionProfile;
+	};
+
+	namespace PathFileDetail {
+		inline bool contains(std::string_view line, std::string_view text) {
+			return line.find(text) != std::string_view::npos;
+		}
+
+		/**
+		 * @brief Parse a number at the start of text, skipping leading spaces, and move text past it
+		 */
+		inline bool parseNumber(std::string_view& text, float& value) {
+			size_t start = text.find_first_not_of(" \t");
+			if (start == std::string_view::npos) {
+				return false;
+			}
+
+			const char* begin = text.data() + start;
+			const char* end = text.data() + text.size();
+
+			// strtod needs a terminated string, so the characters a number can be made of are copied out first. That
+			// also keeps it from reading inf, nan or hex floats. Nothing calls setlocale, so the decimal point is always a dot.
+			char token[64];
+			size_t length = 0;
+
+			while (begin + length < end && length + 1 < sizeof(token) && begin[length] != '\0' && strchr("0123456789+-.eE", begin[length]) != nullptr) {
+				token[length] = begin[length];
+				length++;
+			}
+
+			token[length] = '\0';
+
+			char* parsedEnd;
+			double number = strtod(token, &parsedEnd);
+
+			// Anything off the field by this much is garbage, and would only blow up the planner
+			if (parsedEnd == token || !std::isfinite(number) || fabs(number) > 1.0e6) {
+				return false;
+			}
+
+			value = (float) number;
+			text.remove_prefix(begin + (parsedEnd - token) - text.data());
+
+			return true;
+		}
+
+		/**
+		 * @brief Parse "x_in, y_in" after "PathPlanner::Point(" on a line
+		 */
+		inline bool parsePoint(std::string_view line, float point[2]) {
+			constexpr std::string_view prefix = "PathPlanner::Point(";
+
+			size_t start = line.find(prefix);
+			if (start == std::string_view::npos) {
+				return false;
+			}
+
+			std::string_view text = line.substr(start + prefix.size());
+
+			if (!parseNumber(text, point[0])) {
+				return false;
+			}
+
+			size_t comma = text.find(',');
+			if (comma == std::string_view::npos) {
+				return false;
+			}
+
+			text.remove_prefix(comma + 1);
+
+			return parseNumber(text, point[1]);
+		}
+	} // namespace PathFileDetail
+
+	/**
+	 * @brief Read the splines out of a path header written by the editor
+	 *
+	 * The file is C++, but only the lines the editor writes are looked at: point lines, the inverted flag after every
+	 * fourth point, the motion profile line and the declaration that holds the path name. Lines that don't parse are
+	 * skipped and a spline missing its inverted flag or motion profile gets false and "0.0", so any file can be read
+	 * without crashing. Lines are looked at in place, the only allocations are for the results.
+	 *
+	 * @param data Contents of the file, doesn't have to be null terminated
+	 * @param size Length of the contents
+	 * @param name Set to the name of the path if the file has one
+	 * @param splines Cleared, then filled with every spline in the file
+	 * @return bool Whether every point parsed and every spline had its inverted flag and motion profile
+	 */
+	inline bool readPathFile(const char* data, size_t size, std::string& name, std::vector<PathFileSpline>& splines) {
+		using namespace PathFileDetail;
+
+		std::string_view file(data, size);
+
+		std::vector<bool> inverted;
+		std::vector<std::string_view> motionProfiles;
+
+		splines.clear();
+
+		float points[4][2];
+		int pointCount = 0;
+		bool valid = true;
+
+		while (!file.empty()) {
+			size_t lineEnd = file.find('\n');
+			std::string_view line = file.substr(0, lineEnd);
+			file.remove_prefix(lineEnd == std::string_view::npos ? file.size() : lineEnd + 1);
+
+			if (contains(line, "PathPlanner::Point")) {
+				if (!parsePoint(line, points[pointCount])) {
+					valid = false;
+					continue;
+				}
+
+				if (++pointCount == 4) {
+					PathFileSpline spline{};
+					std::copy(&points[0][0], &points[0][0] + 8, &spline.points[0][0]);
+					splines.emplace_back(spline);
+					pointCount = 0;
+				}
+			} else if (contains(line, "std::vector")) {
+				// Checked before the inverted flags so a name with true or false in it isn't taken as one
+				// The name is the third word: std::vector<...> name = {
+				size_t first = line.find(' ');
+				size_t second = first == std::string_view::npos ? first : line.find(' ', first + 1);
+				size_t third = second == std::string_view::npos ? second : line.find(' ', second + 1);
+
+				if (third != std::string_view::npos) {
+					name = std::string(line.substr(second + 1, third - second - 1));
+				}
+			} else if (contains(line, "true")) {
+				inverted.emplace_back(true);
+			} else if (contains(line, "false")) {
+				inverted.emplace_back(false);
+			} else if (contains(line, "{}") || contains(line, "0.0") || contains(line, "nullptr")) {
+				// Older paths store a null profile pointer instead of a speed
+				motionProfiles.emplace_back("0.0");
+			} else if (contains(line, "getValue") || contains(line, "second")) {
+				motionProfiles.emplace_back(line.substr(0, line.find('}')));
+			}
+		}
+
+		for (size_t i = 0; i < splines.size(); i++) {
+			splines[i].inverted = i < inverted.size() && inverted[i];
+			splines[i].motionProfile = i < motionProfiles.size() ? std::string(motionProfiles[i]) : "0.0";
+		}
+
+		return valid && pointCount == 0 && inverted.size() >= splines.size() && motionProfiles.size() >= splines.size();
+	}
+
+	/**
+	 * @brief Read the splines out of a path header in a stream
+	 */
+	inline bool readPathFile(std::istream& file, std::string& name, std::vector<PathFileSpline>& splines) {
+		std::ostringstream contents;
+		contents << file.rdbuf();
+
+		std::string text = contents.str();
+
+		return readPathFile(text.data(), text.size(), name, splines);
+	}
+} // namespace PathPlanner
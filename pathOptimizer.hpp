@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bezierSegment.hpp"
+#include "velocityPlanner.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Control points of one segment of a path, in field inches
+	 */
+	typedef std::array<Point, 4> ControlPoints;
+
+	/**
+	 * @brief Moves the handles of a path to shorten the time the velocity planner gives for it
+	 *
+	 * The endpoints of every segment stay where they are. Each joint between two segments gets a handle direction and
+	 * the length of the handle on either side, so the path stays tangent continuous however the parameters change. The
+	 * start and end headings of the path are kept and only their handle lengths change.
+	 *
+	 * The optimizer does gradient descent with central finite differences on its own thread, the planner runs for the
+	 * perturbed paths are spread over every core. Every improved path is published and can be picked up with
+	 * takeImprovement().
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class PathOptimizer {
+	private:
+		/**
+		 * @brief Angles are scaled by this so a step in an angle is about as big a change as a step in a length
+		 */
+		static constexpr double angleScale = 10.0;
+
+		static constexpr double minimumHandle = 0.5;
+
+		PlannerConstraints constraints{};
+
+		std::vector<ControlPoints> initialPath;
+		std::vector<bool> inverted;
+
+		// Which side of the joint the incoming handle is on, -1 for cusps where the path doubles back
+		std::vector<double> incomingSide;
+		std::vector<double> startHeading;
+
+		std::thread worker;
+		std::atomic<bool> stopRequested{false};
+		std::atomic<bool> running{false};
+
+		std::mutex mutex;
+		std::vector<ControlPoints> bestPath;
+		double bestTime{0.0};
+		bool improved{false};
+
+		static Point offset(Point point, double length, double angle) {
+			return (Vec2(point) + Vec2::fromPolar(length * inch.getValue(), angle)).toPoint();
+		}
+
+		static double angleOf(Point from, Point to) {
+			Vec2 direction = Vec2(to) - Vec2(from);
+
+			return atan2(direction.y, direction.x);
+		}
+
+		/**
+		 * @brief Parameters that describe the initial path, also sets up the handle sides and the end headings
+		 *
+		 * The parameters are the start handle length, then the direction, incoming and outgoing handle lengths of every
+		 * joint, then the end handle length
+		 */
+		std::vector<double> getInitialParameters() {
+			int n = initialPath.size();
+			std::vector<double> parameters;
+
+			incomingSide.assign(n + 1, 1.0);
+			startHeading.assign(2, 0.0);
+
+			startHeading[0] = angleOf(initialPath[0][0], initialPath[0][1]);
+			startHeading[1] = angleOf(initialPath[n - 1][2], initialPath[n - 1][3]);
+
+			parameters.emplace_back(initialPath[0][0].distance(initialPath[0][1]).Convert(inch));
+
+			for (int joint = 1; joint < n; joint++) {
+				Point position = initialPath[joint][0];
+				double angle = angleOf(position, initialPath[joint][1]);
+				double incomingAngle = angleOf(initialPath[joint - 1][2], position);
+
+				incomingSide[joint] = cos(incomingAngle - angle) >= 0.0 ? 1.0 : -1.0;
+
+				parameters.emplace_back(angle * angleScale);
+				parameters.emplace_back(initialPath[joint - 1][2].distance(position).Convert(inch));
+				parameters.emplace_back(position.distance(initialPath[joint][1]).Convert(inch));
+			}
+
+			parameters.emplace_back(initialPath[n - 1][2].distance(initialPath[n - 1][3]).Convert(inch));
+
+			return parameters;
+		}
+
+		std::vector<ControlPoints> buildPath(const std::vector<double>& parameters) const {
+			int n = initialPath.size();
+			std::vector<ControlPoints> path = initialPath;
+
+			path[0][1] = offset(initialPath[0][0], std::max(minimumHandle, parameters[0]), startHeading[0]);
+
+			for (int joint = 1; joint < n; joint++) {
+				double angle = parameters[1 + (joint - 1) * 3] / angleScale;
+				double incoming = std::max(minimumHandle, parameters[2 + (joint - 1) * 3]);
+				double outgoing = std::max(minimumHandle, parameters[3 + (joint - 1) * 3]);
+
+				path[joint - 1][2] = offset(initialPath[joint][0], -incomingSide[joint] * incoming, angle);
+				path[joint][1] = offset(initialPath[joint][0], outgoing, angle);
+			}
+
+			path[n - 1][2] = offset(initialPath[n - 1][3], -std::max(minimumHandle, parameters.back()), startHeading[1]);
+
+			return path;
+		}
+
+		double evaluate(const std::vector<double>& parameters) const {
+			return getTime(buildPath(parameters), inverted, constraints);
+		}
+
+		/**
+		 * @brief Evaluate a batch of parameter sets, split over every core
+		 */
+		std::vector<double> evaluateAll(const std::vector<std::vector<double>>& candidates) const {
+			std::vector<double> times(candidates.size(), INFINITY);
+
+			int threads = std::max(1u, std::min<unsigned>(std::thread::hardware_concurrency(), candidates.size()));
+			std::vector<std::thread> workers;
+
+			for (int t = 0; t < threads; t++) {
+				workers.emplace_back([&, t]() {
+					for (size_t i = t; i < candidates.size() && !stopRequested; i += threads) {
+						times[i] = evaluate(candidates[i]);
+					}
+				});
+			}
+
+			for (auto &thread : workers) {
+				thread.join();
+			}
+
+			return times;
+		}
+
+		void publish(const std::vector<double>& parameters, double time) {
+			std::lock_guard<std::mutex> lock(mutex);
+			bestPath = buildPath(parameters);
+			bestTime = time;
+			improved = true;
+		}
+
+		void run(int maxIterations) {
+			std::vector<double> parameters = getInitialParameters();
+			double time = evaluate(parameters);
+
+			double step = 4.0;
+			const double difference = 0.25;
+
+			for (int iteration = 0; iteration < maxIterations && !stopRequested && step > 0.05; iteration++) {
+				std::vector<std::vector<double>> candidates;
+
+				for (int i = 0; i < parameters.size(); i++) {
+					candidates.emplace_back(parameters);
+					candidates.back()[i] += difference;
+					candidates.emplace_back(parameters);
+					candidates.back()[i] -= difference;
+				}
+
+				std::vector<double> times = evaluateAll(candidates);
+
+				std::vector<double> gradient(parameters.size());
+				double norm = 0.0;
+
+				for (int i = 0; i < parameters.size(); i++) {
+					gradient[i] = (times[i * 2] - times[i * 2 + 1]) / (2.0 * difference);
+					norm += gradient[i] * gradient[i];
+				}
+
+				norm = sqrt(norm);
+
+				if (stopRequested || norm == 0.0 || std::isnan(norm)) {
+					break;
+				}
+
+				// Try a few step sizes along the gradient at once, keep the best
+				std::vector<std::vector<double>> steps;
+				for (double scale : {2.0, 1.0, 0.5, 0.25}) {
+					steps.emplace_back(parameters);
+					for (int i = 0; i < parameters.size(); i++) {
+						steps.back()[i] -= step * scale * gradient[i] / norm;
+					}
+				}
+
+				std::vector<double> stepTimes = evaluateAll(steps);
+				int best = std::min_element(stepTimes.begin(), stepTimes.end()) - stepTimes.begin();
+
+				if (stepTimes[best] < time) {
+					parameters = steps[best];
+					time = stepTimes[best];
+					step *= best == 0 ? 2.0 : 1.0;
+					publish(parameters, time);
+				} else {
+					step *= 0.25;
+				}
+			}
+
+			running = false;
+		}
+
+	public:
+		PathOptimizer() = default;
+
+		PathOptimizer(const PathOptimizer&) = delete;
+		PathOptimizer& operator=(const PathOptimizer&) = delete;
+
+		/**
+		 * @brief Total time the velocity planner gives for a path
+		 */
+		static double getTime(const std::vector<ControlPoints>& path, const std::vector<bool>& inverted, PlannerConstraints constraints) {
+			std::vector<BezierSegment> segments;
+
+			for (auto &controlPoints : path) {
+				segments.emplace_back(controlPoints[0], controlPoints[1], controlPoints[2], controlPoints[3]);
+			}
+
+			return VelocityPlanner(constraints).calculate(segments, inverted).duration.Convert(second);
+		}
+
+		/**
+		 * @brief Start optimizing a path on the worker thread, stopping any optimization already running
+		 *
+		 * @param path Control points of every segment in field inches
+		 * @param inverted Whether each segment is driven backwards
+		 * @param constraints Limits of the robot the path is planned for
+		 * @param maxIterations Number of gradient steps before giving up
+		 */
+		void start(const std::vector<ControlPoints>& path, const std::vector<bool>& inverted, PlannerConstraints constraints, int maxIterations = 200) {
+			stop();
+
+			if (path.empty()) {
+				return;
+			}
+
+			this->initialPath = path;
+			this->inverted = inverted;
+			this->constraints = constraints;
+			improved = false;
+			stopRequested = false;
+			running = true;
+
+			worker = std::thread(&PathOptimizer::run, this, maxIterations);
+		}
+
+		/**
+		 * @brief Stop the worker, waiting for the current evaluations to finish. An improvement that wasn't taken yet is
+		 * dropped, it is from before whatever edit stopped the optimizer.
+		 */
+		void stop() {
+			stopRequested = true;
+
+			if (worker.joinable()) {
+				worker.join();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				improved = false;
+				bestPath.clear();
+			}
+
+			running = false;
+		}
+
+		bool isRunning() const {
+			return running;
+		}
+
+		/**
+		 * @brief Get the newest improved path if there is one that hasn't been taken yet
+		 *
+		 * @param path Set to the improved control points
+		 * @param time Set to the planned time of the improved path in seconds
+		 * @return bool Whether there was an improvement
+		 */
+		bool takeImprovement(std::vector<ControlPoints>& path, double& time) {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (!improved) {
+				return false;
+			}
+
+			path = bestPath;
+			time = bestTime;
+			improved = false;
+
+			return true;
+		}
+
+		~PathOptimizer() {
+			stop();
+		}
+	};
+} // namespace PathPlanner
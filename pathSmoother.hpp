@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include "pathOptimizer.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Solve a tridiagonal system with the Thomas algorithm, once for x and once for y with the same matrix
+	 *
+	 * Only stable for diagonally dominant systems, which the smoothing system always is.
+	 *
+	 * @param lower Below the diagonal, lower[0] is unused
+	 * @param diagonal The diagonal, overwritten
+	 * @param upper Above the diagonal, the last one is unused
+	 * @param x Right hand side for x, overwritten with the solution
+	 * @param y Right hand side for y, overwritten with the solution
+	 */
+	inline void solveTridiagonal(const std::vector<double>& lower, std::vector<double>& diagonal, const std::vector<double>& upper, std::vector<double>& x, std::vector<double>& y) {
+		int n = diagonal.size();
+
+		for (int i = 1; i < n; i++) {
+			double factor = lower[i] / diagonal[i - 1];
+
+			diagonal[i] -= factor * upper[i - 1];
+			x[i] -= factor * x[i - 1];
+			y[i] -= factor * y[i - 1];
+		}
+
+		x[n - 1] /= diagonal[n - 1];
+		y[n - 1] /= diagonal[n - 1];
+
+		for (int i = n - 2; i >= 0; i--) {
+			x[i] = (x[i] - upper[i] * x[i + 1]) / diagonal[i];
+			y[i] = (y[i] - upper[i] * y[i + 1]) / diagonal[i];
+		}
+	}
+
+	/**
+	 * @brief Move the interior handles of a path so curvature is continuous at every joint
+	 *
+	 * The endpoints of every segment, the first handle of the path and the last handle of the path stay where they are,
+	 * the rest of the handles are solved for so the first and second derivatives match across every joint. Joints where
+	 * the robot changes direction are cusps and aren't smoothed, the segments on either side of one are smoothed as
+	 * separate paths that keep their handles at the cusp.
+	 *
+	 * With the joints K, first handles A and second handles B of n segments, matching derivatives at joint i gives
+	 * B[i-1] = 2K[i] - A[i] and A[i-1] + 4A[i] + A[i+1] = 4K[i] + 2K[i+1], a tridiagonal system in the first handles that
+	 * is solved in linear time.
+	 *
+	 * @param path Control points of every segment in field inches, changed in place
+	 * @param inverted Whether each segment is driven backwards
+	 */
+	inline void smoothPath(std::vector<ControlPoints>& path, const std::vector<bool>& inverted) {
+		std::vector<double> lower, diagonal, upper, x, y;
+
+		size_t start = 0;
+
+		while (start < path.size()) {
+			size_t end = start + 1;
+
+			while (end < path.size() && (end >= inverted.size() || inverted[end] == inverted[start])) {
+				end++;
+			}
+
+			// Segments start to end - 1 drive the same direction, the unknowns are the first handles of segments
+			// start + 1 to end - 1
+			int n = end - start - 1;
+
+			if (n > 0) {
+				lower.assign(n, 1.0);
+				diagonal.assign(n, 4.0);
+				upper.assign(n, 1.0);
+				x.resize(n);
+				y.resize(n);
+
+				for (int i = 0; i < n; i++) {
+					Point& joint = path[start + i + 1][0];
+					Point& next = i == n - 1 ? path[end - 1][2] : path[start + i + 2][0];
+
+					// The last equation uses the fixed end handle in place of the handle after it
+					double nextWeight = i == n - 1 ? 1.0 : 2.0;
+
+					x[i] = 4.0 * joint.getX().getValue() + nextWeight * next.getX().getValue();
+					y[i] = 4.0 * joint.getY().getValue() + nextWeight * next.getY().getValue();
+				}
+
+				// The first handle of the run is fixed
+				x[0] -= path[start][1].getX().getValue();
+				y[0] -= path[start][1].getY().getValue();
+
+				solveTridiagonal(lower, diagonal, upper, x, y);
+
+				for (int i = 0; i < n; i++) {
+					size_t segment = start + i + 1;
+					Point& joint = path[segment][0];
+
+					path[segment][1] = Point(x[i], y[i]);
+					path[segment - 1][2] = Point(2.0 * joint.getX().getValue() - x[i], 2.0 * joint.getY().getValue() - y[i]);
+				}
+			}
+
+			start = end;
+		}
+	}
+} // namespace PathPlanner
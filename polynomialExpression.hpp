@@ -35,8 +35,9 @@ namespace PathPlanner {
 		double evaluate(double x) {
 			double result = 0.0;
 
-			for (int i = 0; i < coefficients.size(); i++) {
-				result += pow(x, i) * coefficients.at(i);
+			// Horner's method, no powers
+			for (int i = (int) coefficients.size() - 1; i >= 0; i--) {
+				result = result * x + coefficients[i];
 			}
 
 			return result;
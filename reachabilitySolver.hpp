@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace PathPlanner {
+
+	/**
+	 * @brief A linear limit on one stage, acceleration * u + squaredSpeed * x <= bound
+	 */
+	struct StageConstraint {
+		double acceleration;
+		double squaredSpeed;
+		double bound;
+	};
+
+	/**
+	 * @brief Time optimal speeds along a sampled path by reachability analysis
+	 *
+	 * Every sample is a stage with the squared speed x as its state and the acceleration u to the next sample as its
+	 * control, so x[i + 1] = x[i] + 2 u[i] ds. The limits on a stage are linear in u and x, which covers speed,
+	 * acceleration, per wheel and lateral limits. The backward pass works out the range of squared speeds at each stage
+	 * from which the robot can still stop at the end, then the forward pass takes the hardest acceleration that stays in
+	 * those ranges. That is the time optimal profile for the limits, and with the start and end at rest it is always
+	 * feasible.
+	 *
+	 * The range at a stage is a two variable LP, solved in closed form by eliminating u: every pair of a limit from above
+	 * and a limit from below on u bounds x. There are only a handful of limits per stage, so the solve is linear in the
+	 * number of samples.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class ReachabilitySolver {
+	private:
+		std::vector<StageConstraint> constraints;
+		std::vector<int> stageStarts;
+		std::vector<double> maxSquaredSpeeds;
+
+		/**
+		 * @brief Fastest squared speed at each stage the robot can still stop from, worked out by solve. Standing still
+		 * is always allowed so the slowest is always 0.
+		 */
+		std::vector<double> controllableMax;
+
+		/**
+		 * @brief A limit on u of the form u <= offset + slope * x, or u >= for limits from below
+		 */
+		struct Line {
+			double offset;
+			double slope;
+		};
+
+		/**
+		 * @brief Split the limits of a stage and the step to the next stage into limits on u from above and below, the
+		 * ones without u go straight into the fastest x
+		 */
+		double getLines(int stage, double distanceChange, double nextMax, std::vector<Line>& upper, std::vector<Line>& lower) const {
+			upper.clear();
+			lower.clear();
+
+			double xMax = maxSquaredSpeeds[stage];
+
+			for (int i = stageStarts[stage]; i < stageStarts[stage + 1]; i++) {
+				const StageConstraint& constraint = constraints[i];
+
+				if (constraint.acceleration > 0.0) {
+					upper.push_back({constraint.bound / constraint.acceleration, -constraint.squaredSpeed / constraint.acceleration});
+				} else if (constraint.acceleration < 0.0) {
+					lower.push_back({constraint.bound / constraint.acceleration, -constraint.squaredSpeed / constraint.acceleration});
+				} else if (constraint.squaredSpeed > 0.0) {
+					xMax = std::min(xMax, constraint.bound / constraint.squaredSpeed);
+				}
+			}
+
+			// 0 <= x + 2 u ds <= nextMax
+			upper.push_back({nextMax / (2.0 * distanceChange), -1.0 / (2.0 * distanceChange)});
+			lower.push_back({0.0, -1.0 / (2.0 * distanceChange)});
+
+			return xMax;
+		}
+
+		/**
+		 * @brief Fastest x a stage can be at and still reach the next stage at no more than nextMax
+		 */
+		double getControllableMax(int stage, double distanceChange, double nextMax, std::vector<Line>& upper, std::vector<Line>& lower) const {
+			// Samples on top of each other share a speed, there is no acceleration between them so every limit has to
+			// hold with u = 0
+			if (distanceChange <= 0.0) {
+				double xMax = std::min(getLines(stage, 1.0, nextMax, upper, lower), nextMax);
+
+				for (const Line& above : upper) {
+					if (above.slope < 0.0) {
+						xMax = std::min(xMax, -above.offset / above.slope);
+					}
+				}
+
+				for (const Line& below : lower) {
+					if (below.slope > 0.0) {
+						xMax = std::min(xMax, -below.offset / below.slope);
+					}
+				}
+
+				return std::max(0.0, xMax);
+			}
+
+			double xMax = getLines(stage, distanceChange, nextMax, upper, lower);
+
+			// lower(x) <= upper(x) for every pair is exactly the x that leave some u, x >= 0 always does
+			for (const Line& above : upper) {
+				for (const Line& below : lower) {
+					double slope = below.slope - above.slope;
+					double offset = above.offset - below.offset;
+
+					if (slope > 0.0) {
+						xMax = std::min(xMax, offset / slope);
+					} else if (slope == 0.0 && offset < 0.0) {
+						xMax = 0.0;
+					}
+				}
+			}
+
+			// Can only come out under 0 from rounding
+			return std::max(0.0, xMax);
+		}
+
+	public:
+		/**
+		 * @brief Start a new stage, the limits added after this belong to it
+		 *
+		 * @param maxSquaredSpeed Fastest the robot can go at the stage squared, 0 to stop there
+		 */
+		void addStage(double maxSquaredSpeed) {
+			if (stageStarts.empty()) {
+				stageStarts.emplace_back(0);
+			}
+
+			maxSquaredSpeeds.emplace_back(std::max(0.0, maxSquaredSpeed));
+			stageStarts.emplace_back(constraints.size());
+		}
+
+		/**
+		 * @brief Add a limit to the last stage, acceleration * u + squaredSpeed * x <= bound. The bound has to be at least
+		 * 0 so standing still is always allowed.
+		 */
+		void addConstraint(double acceleration, double squaredSpeed, double bound) {
+			constraints.push_back({acceleration, squaredSpeed, bound});
+			stageStarts.back() = constraints.size();
+		}
+
+		void reserve(int stages, int constraintsPerStage) {
+			constraints.reserve(stages * constraintsPerStage);
+			stageStarts.reserve(stages + 1);
+			maxSquaredSpeeds.reserve(stages);
+		}
+
+		void clear() {
+			constraints.clear();
+			stageStarts.clear();
+			maxSquaredSpeeds.clear();
+			controllableMax.clear();
+		}
+
+		int size() const {
+			return maxSquaredSpeeds.size();
+		}
+
+		/**
+		 * @brief Find the fastest squared speeds starting and ending at rest
+		 *
+		 * @param distances Distance of every stage along the path, increasing
+		 * @return Squared speed at every stage
+		 */
+		std::vector<double> solve(const std::vector<double>& distances) {
+			int stages = size();
+			std::vector<double> squaredSpeeds(stages, 0.0);
+
+			controllableMax.assign(stages, 0.0);
+
+			std::vector<Line> upper;
+			std::vector<Line> lower;
+
+			// The last stage ends at rest
+			for (int stage = stages - 2; stage >= 0; stage--) {
+				controllableMax[stage] = getControllableMax(stage, distances[stage + 1] - distances[stage], controllableMax[stage + 1], upper, lower);
+			}
+
+			for (int stage = 0; stage + 1 < stages; stage++) {
+				double distanceChange = distances[stage + 1] - distances[stage];
+				double x = squaredSpeeds[stage];
+
+				if (distanceChange <= 0.0) {
+					squaredSpeeds[stage + 1] = std::min(x, controllableMax[stage + 1]);
+					continue;
+				}
+
+				getLines(stage, distanceChange, controllableMax[stage + 1], upper, lower);
+
+				// x is in the controllable range, so the hardest acceleration allowed keeps the next stage in its range
+				double acceleration = std::numeric_limits<double>::infinity();
+
+				for (const Line& above : upper) {
+					acceleration = std::min(acceleration, above.offset + above.slope * x);
+				}
+
+				squaredSpeeds[stage + 1] = std::clamp(x + 2.0 * acceleration * distanceChange, 0.0, controllableMax[stage + 1]);
+			}
+
+			return squaredSpeeds;
+		}
+
+		/**
+		 * @brief Largest amount any limit is over its bound by with the given squared speeds, 0 if they keep to all of
+		 * them. The acceleration at a stage is the one that reaches the next squared speed, and 0 at the last stage.
+		 *
+		 * @param distances Distance of every stage along the path, increasing
+		 * @param squaredSpeeds Squared speed at every stage, from solve or anywhere else
+		 */
+		double getMaxViolation(const std::vector<double>& distances, const std::vector<double>& squaredSpeeds) const {
+			double violation = 0.0;
+
+			for (int stage = 0; stage < size(); stage++) {
+				double x = squaredSpeeds[stage];
+				double u = 0.0;
+
+				if (stage + 1 < size() && distances[stage + 1] > distances[stage]) {
+					u = (squaredSpeeds[stage + 1] - x) / (2.0 * (distances[stage + 1] - distances[stage]));
+				}
+
+				violation = std::max(violation, x - maxSquaredSpeeds[stage]);
+
+				for (int i = stageStarts[stage]; i < stageStarts[stage + 1]; i++) {
+					violation = std::max(violation, constraints[i].acceleration * u + constraints[i].squaredSpeed * x - constraints[i].bound);
+				}
+			}
+
+			return violation;
+		}
+
+		/**
+		 * @brief Fastest squared speed at a stage the robot can still stop from, from the last solve
+		 */
+		double getControllableMax(int stage) const {
+			return controllableMax.at(stage);
+		}
+	};
+} // namespace PathPlanner
@@ -128,8 +128,6 @@ namespace Pronounce {
 					startOmega = 1_pi/startTime.getValue();
 
 					Tt = startTime;
-
-					std::cout << "HI time1" << Tt.getValue() << std::endl;
 				} else {
 					double a = sqrt(this->getDistance().getValue()/(2*1_pi*this->getProfileConstraints().maxAcceleration.getValue()));
 					startSlope = - a * this->getProfileConstraints().maxAcceleration.getValue();
@@ -138,8 +136,6 @@ namespace Pronounce {
 					startOmega = 1.0/a;
 
 					Tt = startTime;
-
-					std::cout << "HI time2" << Tt.getValue() << std::endl;
 				}
 
 				return;
@@ -148,8 +144,6 @@ namespace Pronounce {
 			endStartTime = startTime + middleDuration;
 
 			Tt = endStartTime + endTime;
-
-			std::cout << "HI time3" << Tt.getValue() << std::endl;
 		}
 
 		void setDistance(QLength distance) {
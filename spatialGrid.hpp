@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Uniform grid of points for finding the points near a position without checking every point
+	 *
+	 * Points are identified by an id chosen by the caller, ids should be small and dense since positions are stored in a
+	 * vector indexed by id. Moving a point only touches the grid if it crosses into another cell.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class SpatialGrid {
+	private:
+		float cellSize;
+
+		std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+
+		std::vector<float> xs;
+		std::vector<float> ys;
+		std::vector<bool> present;
+
+		int64_t getCell(float value) const {
+			return (int64_t) std::floor(value / cellSize);
+		}
+
+		static uint64_t getKey(int64_t x, int64_t y) {
+			return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+		}
+
+		void removeFromCell(uint32_t id) {
+			auto cell = cells.find(getKey(getCell(xs[id]), getCell(ys[id])));
+
+			if (cell == cells.end()) {
+				return;
+			}
+
+			std::vector<uint32_t>& ids = cell->second;
+
+			for (size_t i = 0; i < ids.size(); i++) {
+				if (ids[i] == id) {
+					ids[i] = ids.back();
+					ids.pop_back();
+					break;
+				}
+			}
+
+			if (ids.empty()) {
+				cells.erase(cell);
+			}
+		}
+
+	public:
+		/**
+		 * @brief Construct a new Spatial Grid
+		 *
+		 * @param cellSize Width of a cell, about the query radius works best
+		 */
+		explicit SpatialGrid(float cellSize = 16.0) : cellSize(cellSize) {}
+
+		/**
+		 * @brief Add a point or move it if it is already in the grid
+		 */
+		void update(uint32_t id, float x, float y) {
+			if (id >= present.size()) {
+				xs.resize(id + 1);
+				ys.resize(id + 1);
+				present.resize(id + 1, false);
+			}
+
+			if (present[id]) {
+				if (getCell(xs[id]) == getCell(x) && getCell(ys[id]) == getCell(y)) {
+					xs[id] = x;
+					ys[id] = y;
+					return;
+				}
+
+				removeFromCell(id);
+			}
+
+			xs[id] = x;
+			ys[id] = y;
+			present[id] = true;
+
+			cells[getKey(getCell(x), getCell(y))].emplace_back(id);
+		}
+
+		void remove(uint32_t id) {
+			if (id < present.size() && present[id]) {
+				removeFromCell(id);
+				present[id] = false;
+			}
+		}
+
+		void clear() {
+			cells.clear();
+			xs.clear();
+			ys.clear();
+			present.clear();
+		}
+
+		/**
+		 * @brief Find every point within a radius of a position
+		 *
+		 * @param x X of the position
+		 * @param y Y of the position
+		 * @param radius Distance to search
+		 * @param result Cleared, then filled with the ids of the points found
+		 */
+		void query(float x, float y, float radius, std::vector<uint32_t>& result) const {
+			result.clear();
+
+			for (int64_t cellX = getCell(x - radius); cellX <= getCell(x + radius); cellX++) {
+				for (int64_t cellY = getCell(y - radius); cellY <= getCell(y + radius); cellY++) {
+					auto cell = cells.find(getKey(cellX, cellY));
+
+					if (cell == cells.end()) {
+						continue;
+					}
+
+					for (auto &id : cell->second) {
+						float dx = xs[id] - x;
+						float dy = ys[id] - y;
+
+						if (dx * dx + dy * dy <= radius * radius) {
+							result.emplace_back(id);
+						}
+					}
+				}
+			}
+		}
+	};
+} // namespace PathPlanner
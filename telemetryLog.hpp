@@ -0,0 +1,704 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PathPlanner {
+
+	/**
+	 * @brief A read only file mapped into memory, pages are read by the OS as they are touched so opening a large file is
+	 * instant. Read into memory in one go where there is no mmap.
+	 */
+	class MappedFile {
+	private:
+		const char* data{nullptr};
+		size_t size{0};
+
+#ifndef _WIN32
+		void* mapping{nullptr};
+#else
+		std::vector<char> buffer;
+#endif
+
+	public:
+		MappedFile() = default;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const std::string& filename) {
+			close();
+
+#ifndef _WIN32
+			int descriptor = ::open(filename.c_str(), O_RDONLY);
+			if (descriptor < 0) {
+				return false;
+			}
+
+			struct stat status{};
+			if (fstat(descriptor, &status) != 0) {
+				::close(descriptor);
+				return false;
+			}
+
+			size = status.st_size;
+
+			if (size > 0) {
+				mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+				if (mapping == MAP_FAILED) {
+					mapping = nullptr;
+					size = 0;
+					::close(descriptor);
+					return false;
+				}
+
+				// The file is read front to back once, so the OS can read ahead and drop pages behind the parser
+				madvise(mapping, size, MADV_SEQUENTIAL);
+				data = (const char*) mapping;
+			}
+
+			// The mapping keeps the file open
+			::close(descriptor);
+#else
+			FILE* file = fopen(filename.c_str(), "rb");
+			if (file == nullptr) {
+				return false;
+			}
+
+			char chunk[1 << 16];
+			size_t read;
+			while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+				buffer.insert(buffer.end(), chunk, chunk + read);
+			}
+			fclose(file);
+
+			data = buffer.data();
+			size = buffer.size();
+#endif
+
+			return true;
+		}
+
+		void close() {
+#ifndef _WIN32
+			if (mapping != nullptr) {
+				munmap(mapping, size);
+				mapping = nullptr;
+			}
+#else
+			buffer = std::vector<char>();
+#endif
+
+			data = nullptr;
+			size = 0;
+		}
+
+		const char* getData() const {
+			return data;
+		}
+
+		size_t getSize() const {
+			return size;
+		}
+
+		~MappedFile() {
+			close();
+		}
+	};
+
+	/**
+	 * @brief Columns of a telemetry log
+	 */
+	enum TelemetryChannel {
+		TelemetryTime,
+		TelemetryX,
+		TelemetryY,
+		TelemetryHeading,
+		TelemetryVelocity,
+		TelemetryChannelCount
+	};
+
+	/**
+	 * @brief Decimated rows of a telemetry log, one array per channel
+	 */
+	struct TelemetryTrace {
+		std::array<std::vector<float>, TelemetryChannelCount> channels;
+
+		size_t size() const {
+			return channels[TelemetryTime].size();
+		}
+
+		const float* get(TelemetryChannel channel) const {
+			return channels[channel].data();
+		}
+	};
+
+	/**
+	 * @brief Odometry recorded on the robot, loaded on a background thread so logs of hundreds of megabytes can be
+	 * opened without stalling the editor and drawn while the rest of them is still being parsed
+	 *
+	 * Two formats are read, both with time in seconds, x and y in field inches, heading in degrees and velocity in
+	 * inches per second:
+	 *  - CSV, one row per line. A header row names the columns time, x, y, heading and velocity (t, theta and v work
+	 *    too) in any order, without a header the columns are in that order. Velocity is worked out from the positions if
+	 *    there is no velocity column.
+	 *  - Binary, the 8 bytes "PPTLOG01" followed by records of 5 little endian float32 in the order above.
+	 * Rows are expected in time order.
+	 *
+	 * Every channel keeps a pyramid of the rows with the smallest and largest value in each block of 16 rows, 256 rows and
+	 * so on, so the minimum and maximum over any range of rows are found in a few dozen steps. Decimating to a few
+	 * thousand points with those keeps every peak of the log however many millions of rows it has.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class TelemetryLog {
+	public:
+		enum Status {
+			Empty,
+			Loading,
+			Loaded,
+			Failed
+		};
+
+	private:
+		static constexpr size_t blockSize = 16;
+		static constexpr size_t chunkBytes = 1 << 20;
+		static constexpr char binaryMagic[] = "PPTLOG01";
+
+		struct Extremes {
+			uint32_t min;
+			uint32_t max;
+		};
+
+		mutable std::mutex mutex;
+		std::array<std::vector<float>, TelemetryChannelCount> values;
+
+		// pyramids[channel][level] has the extremes of each block of 16^(level + 1) rows, only whole blocks are kept
+		std::array<std::vector<std::vector<Extremes>>, TelemetryChannelCount> pyramids;
+
+		std::string filename;
+		MappedFile file;
+		std::thread worker;
+		std::atomic<bool> stopRequested{false};
+		std::atomic<Status> status{Empty};
+		std::atomic<size_t> parsedBytes{0};
+
+		/**
+		 * @brief Parse a decimal number without reading past end, for rows that end at the end of the mapping
+		 */
+		static bool parseNumber(const char*& position, const char* end, float& result) {
+			while (position < end && (*position == ' ' || *position == '\t')) {
+				position++;
+			}
+
+			const char* start = position;
+			double sign = 1.0;
+
+			if (position < end && (*position == '-' || *position == '+')) {
+				sign = *position == '-' ? -1.0 : 1.0;
+				position++;
+			}
+
+			double mantissa = 0.0;
+			int exponent = 0;
+			bool digits = false;
+
+			while (position < end && isdigit((unsigned char) *position)) {
+				mantissa = mantissa * 10.0 + (*position - '0');
+				digits = true;
+				position++;
+			}
+
+			if (position < end && *position == '.') {
+				position++;
+
+				while (position < end && isdigit((unsigned char) *position)) {
+					mantissa = mantissa * 10.0 + (*position - '0');
+					exponent--;
+					digits = true;
+					position++;
+				}
+			}
+
+			if (!digits) {
+				position = start;
+				return false;
+			}
+
+			if (position < end && (*position == 'e' || *position == 'E')) {
+				const char* exponentStart = position++;
+				int exponentSign = 1;
+
+				if (position < end && (*position == '-' || *position == '+')) {
+					exponentSign = *position == '-' ? -1 : 1;
+					position++;
+				}
+
+				if (position < end && isdigit((unsigned char) *position)) {
+					int value = 0;
+
+					while (position < end && isdigit((unsigned char) *position)) {
+						value = std::min(value * 10 + (*position - '0'), 1000);
+						position++;
+					}
+
+					exponent += exponentSign * value;
+				} else {
+					position = exponentStart;
+				}
+			}
+
+			result = (float) (sign * mantissa * pow(10.0, exponent));
+
+			return true;
+		}
+
+		/**
+		 * @brief Which channel each CSV column is, -1 for columns that are ignored
+		 */
+		static std::vector<int> parseHeader(const char* position, const char* end) {
+			std::vector<int> columns;
+
+			while (position < end) {
+				const char* start = position;
+				while (position < end && *position != ',') {
+					position++;
+				}
+
+				std::string name;
+				for (const char* character = start; character < position; character++) {
+					if (!isspace((unsigned char) *character) && *character != '"') {
+						name += (char) tolower((unsigned char) *character);
+					}
+				}
+
+				int channel = -1;
+				if (name == "time" || name == "t" || name == "timestamp") {
+					channel = TelemetryTime;
+				} else if (name == "x") {
+					channel = TelemetryX;
+				} else if (name == "y") {
+					channel = TelemetryY;
+				} else if (name == "heading" || name == "theta" || name == "angle") {
+					channel = TelemetryHeading;
+				} else if (name == "velocity" || name == "v" || name == "speed") {
+					channel = TelemetryVelocity;
+				}
+
+				columns.emplace_back(channel);
+				position++;
+			}
+
+			return columns;
+		}
+
+		/**
+		 * @brief Parse the CSV rows between begin and end into rows, rows that don't have a time, x and y are skipped
+		 */
+		static void parseCsv(const char* begin, const char* end, const std::vector<int>& columns, std::array<std::vector<float>, TelemetryChannelCount>& rows) {
+			const char* position = begin;
+
+			while (position < end) {
+				const char* lineEnd = (const char*) memchr(position, '\n', end - position);
+				if (lineEnd == nullptr) {
+					lineEnd = end;
+				}
+
+				float row[TelemetryChannelCount] = {NAN, NAN, NAN, 0.0f, NAN};
+
+				for (size_t column = 0; column < columns.size() && position < lineEnd; column++) {
+					float value;
+
+					if (parseNumber(position, lineEnd, value) && columns[column] >= 0) {
+						row[columns[column]] = value;
+					}
+
+					// On to the next column, whatever is left of this one
+					while (position < lineEnd && *position != ',') {
+						position++;
+					}
+					if (position < lineEnd) {
+						position++;
+					}
+				}
+
+				if (!std::isnan(row[TelemetryTime]) && !std::isnan(row[TelemetryX]) && !std::isnan(row[TelemetryY])) {
+					for (int channel = 0; channel < TelemetryChannelCount; channel++) {
+						rows[channel].emplace_back(row[channel]);
+					}
+				}
+
+				position = lineEnd + 1;
+			}
+		}
+
+		static void parseBinary(const char* begin, const char* end, std::array<std::vector<float>, TelemetryChannelCount>& rows) {
+			const size_t recordSize = TelemetryChannelCount * sizeof(float);
+
+			for (const char* record = begin; record + recordSize <= end; record += recordSize) {
+				for (int channel = 0; channel < TelemetryChannelCount; channel++) {
+					float value;
+					memcpy(&value, record + channel * sizeof(float), sizeof(float));
+					rows[channel].emplace_back(value);
+				}
+			}
+		}
+
+		/**
+		 * @brief Extend the pyramid of a channel over every whole block of the rows
+		 */
+		void extendPyramid(int channel) {
+			const std::vector<float>& channelValues = values[channel];
+			std::vector<std::vector<Extremes>>& levels = pyramids[channel];
+
+			size_t below = channelValues.size();
+
+			for (size_t level = 0; below >= blockSize; level++) {
+				if (levels.size() <= level) {
+					levels.emplace_back();
+				}
+
+				std::vector<Extremes>& entries = levels[level];
+
+				for (size_t block = entries.size(); block < below / blockSize; block++) {
+					Extremes extremes{};
+
+					for (size_t i = block * blockSize; i < (block + 1) * blockSize; i++) {
+						Extremes entry = level == 0 ? Extremes{(uint32_t) i, (uint32_t) i} : levels[level - 1][i];
+
+						if (i == block * blockSize || channelValues[entry.min] < channelValues[extremes.min]) {
+							extremes.min = entry.min;
+						}
+						if (i == block * blockSize || channelValues[entry.max] > channelValues[extremes.max]) {
+							extremes.max = entry.max;
+						}
+					}
+
+					entries.emplace_back(extremes);
+				}
+
+				below = entries.size();
+			}
+		}
+
+		/**
+		 * @brief Add parsed rows, filling in velocity from the positions where the log doesn't have it
+		 */
+		void append(std::array<std::vector<float>, TelemetryChannelCount>& rows) {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			size_t first = values[TelemetryTime].size();
+
+			for (int channel = 0; channel < TelemetryChannelCount; channel++) {
+				values[channel].insert(values[channel].end(), rows[channel].begin(), rows[channel].end());
+				rows[channel].clear();
+			}
+
+			std::vector<float>& velocity = values[TelemetryVelocity];
+
+			for (size_t i = first; i < velocity.size(); i++) {
+				if (!std::isnan(velocity[i])) {
+					continue;
+				}
+
+				velocity[i] = 0.0f;
+
+				if (i > 0) {
+					float dt = values[TelemetryTime][i] - values[TelemetryTime][i - 1];
+					float dx = values[TelemetryX][i] - values[TelemetryX][i - 1];
+					float dy = values[TelemetryY][i] - values[TelemetryY][i - 1];
+
+					velocity[i] = dt > 0.0f ? sqrt(dx * dx + dy * dy) / dt : velocity[i - 1];
+				}
+			}
+
+			for (int channel = 0; channel < TelemetryChannelCount; channel++) {
+				extendPyramid(channel);
+			}
+		}
+
+		void run() {
+			const char* data = file.getData();
+			const char* end = data + file.getSize();
+			const char* position = data;
+
+			std::array<std::vector<float>, TelemetryChannelCount> rows;
+
+			bool binary = file.getSize() >= 8 && memcmp(data, binaryMagic, 8) == 0;
+			std::vector<int> columns = {TelemetryTime, TelemetryX, TelemetryY, TelemetryHeading, TelemetryVelocity};
+
+			if (binary) {
+				position += 8;
+			} else {
+				const char* lineEnd = (const char*) memchr(position, '\n', end - position);
+				if (lineEnd == nullptr) {
+					lineEnd = end;
+				}
+
+				const char* firstCharacter = position;
+				while (firstCharacter < lineEnd && isspace((unsigned char) *firstCharacter)) {
+					firstCharacter++;
+				}
+
+				if (firstCharacter < lineEnd && isalpha((unsigned char) *firstCharacter)) {
+					columns = parseHeader(position, lineEnd);
+					position = std::min(end, lineEnd + 1);
+				}
+			}
+
+			while (position < end && !stopRequested) {
+				const char* chunkEnd = end - position > (ptrdiff_t) chunkBytes ? position + chunkBytes : end;
+
+				if (binary) {
+					size_t recordSize = TelemetryChannelCount * sizeof(float);
+					chunkEnd = position + (chunkEnd - position) / recordSize * recordSize;
+
+					if (chunkEnd == position) {
+						break;
+					}
+
+					parseBinary(position, chunkEnd, rows);
+				} else {
+					// Chunks end on a line so no row is split between two of them
+					const char* lineEnd = chunkEnd < end ? (const char*) memchr(chunkEnd, '\n', end - chunkEnd) : nullptr;
+					chunkEnd = lineEnd == nullptr ? end : lineEnd + 1;
+
+					parseCsv(position, chunkEnd, columns, rows);
+				}
+
+				append(rows);
+
+				position = chunkEnd;
+				parsedBytes = position - data;
+			}
+
+			parsedBytes = file.getSize();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			status = values[TelemetryTime].empty() ? Failed : Loaded;
+		}
+
+		/**
+		 * @brief Rows with the smallest and largest value of a channel from first to end
+		 */
+		void findExtremes(int channel, size_t first, size_t end, uint32_t& minRow, uint32_t& maxRow) const {
+			const std::vector<float>& channelValues = values[channel];
+			const std::vector<std::vector<Extremes>>& levels = pyramids[channel];
+
+			minRow = maxRow = first;
+
+			auto consider = [&](size_t level, size_t index) {
+				Extremes entry = level == 0 ? Extremes{(uint32_t) index, (uint32_t) index} : levels[level - 1][index];
+
+				if (channelValues[entry.min] < channelValues[minRow]) {
+					minRow = entry.min;
+				}
+				if (channelValues[entry.max] > channelValues[maxRow]) {
+					maxRow = entry.max;
+				}
+			};
+
+			// Climb the pyramid, the ragged ends of the range are taken from each level and the whole blocks in the middle
+			// from the level above
+			for (size_t level = 0; first < end; level++) {
+				if (level == levels.size()) {
+					for (size_t i = first; i < end; i++) {
+						consider(level, i);
+					}
+					break;
+				}
+
+				size_t alignedFirst = std::min(end, (first + blockSize - 1) / blockSize * blockSize);
+				size_t alignedEnd = std::max(alignedFirst, end / blockSize * blockSize);
+
+				for (size_t i = first; i < alignedFirst; i++) {
+					consider(level, i);
+				}
+				for (size_t i = alignedEnd; i < end; i++) {
+					consider(level, i);
+				}
+
+				first = alignedFirst / blockSize;
+				end = alignedEnd / blockSize;
+			}
+		}
+
+	public:
+		TelemetryLog() = default;
+
+		/**
+		 * @brief Start loading a log in the background, replacing the one that is loaded
+		 *
+		 * @param filename Path to a .csv or binary log
+		 * @return bool Whether the file could be opened, parsing errors show up as the Failed status later
+		 */
+		bool load(const std::string& filename) {
+			close();
+
+			this->filename = filename;
+
+			if (!file.open(filename)) {
+				status = Failed;
+				return false;
+			}
+
+			status = Loading;
+			worker = std::thread(&TelemetryLog::run, this);
+
+			return true;
+		}
+
+		/**
+		 * @brief Stop loading and drop the log
+		 */
+		void close() {
+			stopRequested = true;
+			if (worker.joinable()) {
+				worker.join();
+			}
+			stopRequested = false;
+
+			file.close();
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for (int channel = 0; channel < TelemetryChannelCount; channel++) {
+				values[channel] = std::vector<float>();
+				pyramids[channel].clear();
+			}
+
+			filename.clear();
+			parsedBytes = 0;
+			status = Empty;
+		}
+
+		Status getStatus() const {
+			return status;
+		}
+
+		const std::string& getFilename() const {
+			return filename;
+		}
+
+		/**
+		 * @brief Share of the file parsed so far, from 0 to 1
+		 */
+		float getProgress() const {
+			return file.getSize() == 0 ? 1.0f : (float) parsedBytes / (float) file.getSize();
+		}
+
+		size_t size() const {
+			std::lock_guard<std::mutex> lock(mutex);
+			return values[TelemetryTime].size();
+		}
+
+		/**
+		 * @brief Time of the first row the robot moves faster than a threshold, for lining the log up with the plan
+		 * which starts moving at 0. The first time in the log if it never does.
+		 */
+		float getMotionStart(float threshold = 1.0) const {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			const std::vector<float>& time = values[TelemetryTime];
+			const std::vector<float>& velocity = values[TelemetryVelocity];
+
+			for (size_t i = 0; i < time.size(); i++) {
+				if (fabs(velocity[i]) > threshold) {
+					return time[i];
+				}
+			}
+
+			return time.empty() ? 0.0f : time.front();
+		}
+
+		/**
+		 * @brief The rows of the log from startTime to endTime decimated to at most a few points per bucket
+		 *
+		 * The rows are split into buckets of equal numbers of rows and the rows with the smallest and largest value of
+		 * each channel in keep are taken from each bucket, so the trace has the same outline as the whole log.
+		 *
+		 * @param startTime Log time to start at
+		 * @param endTime Log time to end at
+		 * @param buckets Number of buckets, about the width in pixels the trace is drawn over
+		 * @param keep Channels whose extremes are kept
+		 */
+		TelemetryTrace getTrace(float startTime, float endTime, int buckets, const std::vector<TelemetryChannel>& keep) const {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			TelemetryTrace trace;
+			const std::vector<float>& time = values[TelemetryTime];
+
+			size_t first = std::lower_bound(time.begin(), time.end(), startTime) - time.begin();
+			size_t end = std::upper_bound(time.begin(), time.end(), endTime) - time.begin();
+
+			// One row either side so the trace reaches the edges of the range
+			first = first > 0 ? first - 1 : 0;
+			end = std::min(time.size(), end + 1);
+
+			if (first >= end || buckets <= 0) {
+				return trace;
+			}
+
+			std::vector<uint32_t> rows;
+			size_t count = end - first;
+
+			if (count <= (size_t) buckets * (2 * keep.size() + 2)) {
+				for (size_t row = first; row < end; row++) {
+					rows.emplace_back(row);
+				}
+			} else {
+				std::vector<uint32_t> bucketRows;
+
+				for (int bucket = 0; bucket < buckets; bucket++) {
+					size_t bucketFirst = first + count * bucket / buckets;
+					size_t bucketEnd = first + count * (bucket + 1) / buckets;
+
+					bucketRows.assign({(uint32_t) bucketFirst, (uint32_t) (bucketEnd - 1)});
+
+					for (auto &channel : keep) {
+						uint32_t minRow, maxRow;
+						findExtremes(channel, bucketFirst, bucketEnd, minRow, maxRow);
+						bucketRows.emplace_back(minRow);
+						bucketRows.emplace_back(maxRow);
+					}
+
+					std::sort(bucketRows.begin(), bucketRows.end());
+					bucketRows.erase(std::unique(bucketRows.begin(), bucketRows.end()), bucketRows.end());
+					rows.insert(rows.end(), bucketRows.begin(), bucketRows.end());
+				}
+			}
+
+			for (int channel = 0; channel < TelemetryChannelCount; channel++) {
+				trace.channels[channel].reserve(rows.size());
+
+				for (auto &row : rows) {
+					trace.channels[channel].emplace_back(values[channel][row]);
+				}
+			}
+
+			return trace;
+		}
+
+		~TelemetryLog() {
+			close();
+		}
+	};
+} // namespace PathPlanner
@@ -0,0 +1,101 @@
+// Bezier segment tests, t found by distance with the fit has to stay close to the reference table everywhere along the
+// segment, not just where the fit was checked when it was made
+//
+// Usage: bezier_segment_test <path file>...
+
+#include "bezierSegment.hpp"
+#include "pathFile.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Largest difference in t a position can be found with
+const double maxTError = 1.0e-4;
+
+// Points checked along each segment
+const int checks = 10000;
+
+int failures = 0;
+
+void expect(bool condition, const std::string& name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name.c_str());
+		failures++;
+	}
+}
+
+/**
+ * @brief Compare t by distance against the table on a dense grid, and a little past both ends
+ */
+void checkSegment(PathPlanner::BezierSegment& segment, const std::string& name) {
+	double worst = 0.0;
+	bool inRange = true;
+
+	for (int i = -checks / 100; i <= checks + checks / 100; i++) {
+		QLength distance = ((double) i / checks) * segment.getDistance();
+		double t = segment.getTByLength(distance);
+
+		inRange = inRange && t >= 0.0 && t <= 1.0;
+
+		if (i >= 0 && i <= checks) {
+			worst = std::max(worst, fabs(t - segment.getReferenceTByLength(distance)));
+		}
+	}
+
+	expect(worst <= maxTError, name + " t is within the bound of the table");
+	expect(inRange, name + " t stays between 0 and 1");
+}
+
+int main(int argc, char** argv) {
+	int fitted = 0;
+	int segments = 0;
+
+	for (int i = 1; i < argc; i++) {
+		std::ifstream pathFile(argv[i]);
+		std::string name;
+		std::vector<PathPlanner::PathFileSpline> splines;
+		PathPlanner::readPathFile(pathFile, name, splines);
+
+		expect(!splines.empty(), std::string(argv[i]) + " has splines");
+
+		for (auto &spline : splines) {
+			PathPlanner::BezierSegment segment(
+					PathPlanner::Point(spline.points[0][0] * 1_in, spline.points[0][1] * 1_in),
+					PathPlanner::Point(spline.points[1][0] * 1_in, spline.points[1][1] * 1_in),
+					PathPlanner::Point(spline.points[2][0] * 1_in, spline.points[2][1] * 1_in),
+					PathPlanner::Point(spline.points[3][0] * 1_in, spline.points[3][1] * 1_in));
+
+			checkSegment(segment, argv[i]);
+			fitted += segment.isFitted();
+			segments++;
+		}
+	}
+
+	// Random segments, some with handles on top of the ends or crossing over so the robot stops inside them
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<double> field(0.0, 144.0);
+
+	for (int i = 0; i < 200; i++) {
+		PathPlanner::Point a(field(random) * 1_in, field(random) * 1_in);
+		PathPlanner::Point d(field(random) * 1_in, field(random) * 1_in);
+		PathPlanner::Point b = i % 10 == 0 ? a : PathPlanner::Point(field(random) * 1_in, field(random) * 1_in);
+		PathPlanner::Point c = i % 10 == 1 ? d : PathPlanner::Point(field(random) * 1_in, field(random) * 1_in);
+
+		PathPlanner::BezierSegment segment(a, b, c, d);
+
+		checkSegment(segment, "random segment " + std::to_string(i));
+		fitted += segment.isFitted();
+		segments++;
+	}
+
+	if (failures > 0) {
+		printf("%d bezier segment checks failed\n", failures);
+		return 1;
+	}
+
+	printf("bezier segment checks passed, %d of %d segments fitted\n", fitted, segments);
+	return 0;
+}
@@ -0,0 +1,110 @@
+// Footprint tests for the obstacle map and conflict checker, a robot that only just clears something must not be
+// reported as hitting it and one that is a little into it must be
+//
+// Usage: footprint_test
+
+#include "bezierSegment.hpp"
+#include "conflictChecker.hpp"
+#include "obstacleMap.hpp"
+#include "velocityPlanner.hpp"
+#include <cstdio>
+#include <vector>
+
+// Same robot as the editor plans for
+const PathPlanner::PlannerConstraints constraints{60_in/second, 100_in/second/second, 8_in};
+const float robotLength = 18.0;
+const float robotWidth = 18.0;
+
+int failures = 0;
+
+void expect(bool condition, const char* name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name);
+		failures++;
+	}
+}
+
+/**
+ * @brief A straight path from one point to another, as the editor would draw it
+ */
+PathPlanner::PlannedPath getStraightPath(float startX, float startY, float endX, float endY) {
+	std::vector<PathPlanner::BezierSegment> segments;
+	std::vector<bool> inverted = {false};
+
+	segments.emplace_back(
+			PathPlanner::Point(startX * 1_in, startY * 1_in),
+			PathPlanner::Point((startX + (endX - startX) / 3.0) * 1_in, (startY + (endY - startY) / 3.0) * 1_in),
+			PathPlanner::Point((startX + (endX - startX) * 2.0 / 3.0) * 1_in, (startY + (endY - startY) * 2.0 / 3.0) * 1_in),
+			PathPlanner::Point(endX * 1_in, endY * 1_in));
+
+	return PathPlanner::VelocityPlanner(constraints).calculate(segments, inverted);
+}
+
+void testWalls() {
+	PathPlanner::ObstacleMap obstacleMap;
+	obstacleMap.build();
+
+	std::vector<float> clearance;
+
+	// Driving along the wall with the side of the robot half an inch off it
+	PathPlanner::PlannedPath hugging = getStraightPath(9.5, 20.0, 9.5, 120.0);
+	expect(obstacleMap.check(hugging, robotLength, robotWidth, clearance) == 0, "wall hugging path is clear");
+	expect(fabs(clearance.front() - 0.5f) < 0.01f, "wall hugging clearance is the gap to the wall");
+
+	// Starting with the back of the robot half an inch off the wall, driving away from it
+	PathPlanner::PlannedPath leaving = getStraightPath(70.0, 9.5, 70.0, 100.0);
+	expect(obstacleMap.check(leaving, robotLength, robotWidth, clearance) == 0, "start against the wall is clear");
+
+	// Half an inch into the wall
+	PathPlanner::PlannedPath scraping = getStraightPath(8.5, 20.0, 8.5, 120.0);
+	expect(obstacleMap.check(scraping, robotLength, robotWidth, clearance) == scraping.size(), "path into the wall hits at every sample");
+}
+
+void testObstacles() {
+	PathPlanner::ObstacleMap obstacleMap;
+	obstacleMap.addPolygon({{60.0f, 60.0f}, {80.0f, 60.0f}, {80.0f, 80.0f}, {60.0f, 80.0f}});
+	obstacleMap.build();
+
+	std::vector<float> clearance;
+
+	// Passing the obstacle with the side of the robot 2 inches off it
+	PathPlanner::PlannedPath passing = getStraightPath(49.0, 20.0, 49.0, 120.0);
+	expect(obstacleMap.check(passing, robotLength, robotWidth, clearance) == 0, "path past the obstacle is clear");
+
+	// Side of the robot 2 inches into the obstacle
+	PathPlanner::PlannedPath through = getStraightPath(53.0, 20.0, 53.0, 120.0);
+	expect(obstacleMap.check(through, robotLength, robotWidth, clearance) > 0, "path into the obstacle hits");
+}
+
+void testPartners() {
+	// Two robots side by side driving the same way at the same time, 2 inches between their sides
+	PathPlanner::ConflictChecker besideChecker;
+	besideChecker.addPartner(getStraightPath(40.0, 20.0, 40.0, 120.0), 0.0, robotLength, robotWidth);
+	expect(!besideChecker.check(getStraightPath(60.0, 20.0, 60.0, 120.0), 0.0, robotLength, robotWidth).found, "robots side by side are clear");
+
+	// 2 inches overlapping
+	PathPlanner::ConflictChecker overlapChecker;
+	overlapChecker.addPartner(getStraightPath(40.0, 20.0, 40.0, 120.0), 0.0, robotLength, robotWidth);
+	PathPlanner::ConflictChecker::Conflict conflict = overlapChecker.check(getStraightPath(56.0, 20.0, 56.0, 120.0), 0.0, robotLength, robotWidth);
+	expect(conflict.found && conflict.time == 0.0f, "overlapping robots conflict from the start");
+	expect(conflict.found && conflict.x > 46.0f && conflict.x < 50.0f, "conflict is where the robots overlap");
+
+	// Driving across the front of a parked partner with 2 inches between them
+	PathPlanner::ConflictChecker cornerChecker;
+	cornerChecker.addPartner(getStraightPath(70.0, 70.0, 70.0, 70.1), 0.0, robotLength, robotWidth);
+	expect(!cornerChecker.check(getStraightPath(20.0, 90.0, 120.0, 90.0), 0.0, robotLength, robotWidth).found, "robot past a parked partner is clear");
+}
+
+int main() {
+	testWalls();
+	testObstacles();
+	testPartners();
+
+	if (failures > 0) {
+		printf("%d footprint checks failed\n", failures);
+		return 1;
+	}
+
+	printf("footprint checks passed\n");
+	return 0;
+}
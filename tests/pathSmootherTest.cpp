@@ -0,0 +1,146 @@
+// Path smoother tests, a smoothed path has to have the same first and second derivatives on both sides of every joint
+// so curvature is continuous, without moving anything the smoother is meant to leave alone
+//
+// Usage: path_smoother_test
+
+#include "bezierSegment.hpp"
+#include "pathSmoother.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Control points are in inches, derivatives of paths this size match to well within this
+const double tolerance = 1.0e-9;
+
+int failures = 0;
+
+void expect(bool condition, const char* name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name);
+		failures++;
+	}
+}
+
+double getDistance(PathPlanner::Point first, PathPlanner::Point second) {
+	return hypot(first.getX().getValue() - second.getX().getValue(), first.getY().getValue() - second.getY().getValue());
+}
+
+/**
+ * @brief A path through random joints with the handles mirrored across each joint, as the editor adds segments
+ */
+std::vector<PathPlanner::ControlPoints> getRandomPath(std::mt19937& random, int count) {
+	std::uniform_real_distribution<double> field(0.0, 144.0);
+	std::uniform_real_distribution<double> arm(-20.0, 20.0);
+
+	std::vector<PathPlanner::ControlPoints> path;
+	PathPlanner::Point joint(field(random), field(random));
+	PathPlanner::Point handle(joint.getX().getValue() + arm(random), joint.getY().getValue() + arm(random));
+
+	for (int i = 0; i < count; i++) {
+		PathPlanner::Point nextJoint(field(random), field(random));
+		PathPlanner::Point nextArm(arm(random), arm(random));
+
+		path.push_back({
+				joint,
+				handle,
+				PathPlanner::Point(nextJoint.getX().getValue() - nextArm.getX().getValue(), nextJoint.getY().getValue() - nextArm.getY().getValue()),
+				nextJoint});
+
+		joint = nextJoint;
+		handle = PathPlanner::Point(nextJoint.getX().getValue() + nextArm.getX().getValue(), nextJoint.getY().getValue() + nextArm.getY().getValue());
+	}
+
+	return path;
+}
+
+/**
+ * @brief Largest difference in first derivative, second derivative and curvature across the joints of a path that aren't
+ * cusps
+ */
+void getJointErrors(const std::vector<PathPlanner::ControlPoints>& path, const std::vector<bool>& inverted, double& velocityError, double& accelerationError, double& curvatureError) {
+	velocityError = 0.0;
+	accelerationError = 0.0;
+	curvatureError = 0.0;
+
+	for (size_t i = 1; i < path.size(); i++) {
+		if (inverted[i] != inverted[i - 1]) {
+			continue;
+		}
+
+		PathPlanner::BezierSegment before(path[i - 1][0], path[i - 1][1], path[i - 1][2], path[i - 1][3]);
+		PathPlanner::BezierSegment after(path[i][0], path[i][1], path[i][2], path[i][3]);
+
+		velocityError = std::max(velocityError, (before.getVelocity(1.0) - after.getVelocity(0.0)).getLength());
+		accelerationError = std::max(accelerationError, (before.getAcceleration(1.0) - after.getAcceleration(0.0)).getLength());
+		curvatureError = std::max(curvatureError, fabs((before.getCurvature(1.0) - after.getCurvature(0.0)).getValue()));
+	}
+}
+
+/**
+ * @brief Random paths that drive one way are C2 after smoothing and keep their joints and end handles
+ */
+void testContinuity() {
+	std::mt19937 random(12345);
+
+	for (int problem = 0; problem < 100; problem++) {
+		std::vector<PathPlanner::ControlPoints> path = getRandomPath(random, 2 + random() % 20);
+		std::vector<bool> inverted(path.size(), false);
+
+		std::vector<PathPlanner::ControlPoints> smoothed = path;
+		PathPlanner::smoothPath(smoothed, inverted);
+
+		double velocityError, accelerationError, curvatureError;
+		getJointErrors(smoothed, inverted, velocityError, accelerationError, curvatureError);
+
+		expect(velocityError < tolerance, "first derivative is continuous at every joint");
+		expect(accelerationError < tolerance, "second derivative is continuous at every joint");
+		expect(curvatureError < tolerance, "curvature is continuous at every joint");
+
+		bool kept = getDistance(smoothed.front()[1], path.front()[1]) == 0.0 && getDistance(smoothed.back()[2], path.back()[2]) == 0.0;
+		for (size_t i = 0; i < path.size(); i++) {
+			kept = kept && getDistance(smoothed[i][0], path[i][0]) == 0.0 && getDistance(smoothed[i][3], path[i][3]) == 0.0;
+		}
+
+		expect(kept, "joints and the end handles of the path don't move");
+	}
+}
+
+/**
+ * @brief The handles either side of a change of direction stay put and the runs either side are each C2
+ */
+void testCusp() {
+	std::mt19937 random(54321);
+
+	for (int problem = 0; problem < 100; problem++) {
+		std::vector<PathPlanner::ControlPoints> path = getRandomPath(random, 4 + random() % 20);
+		size_t cusp = 2 + random() % (path.size() - 3);
+
+		std::vector<bool> inverted(path.size(), false);
+		for (size_t i = cusp; i < path.size(); i++) {
+			inverted[i] = true;
+		}
+
+		std::vector<PathPlanner::ControlPoints> smoothed = path;
+		PathPlanner::smoothPath(smoothed, inverted);
+
+		double velocityError, accelerationError, curvatureError;
+		getJointErrors(smoothed, inverted, velocityError, accelerationError, curvatureError);
+
+		expect(accelerationError < tolerance && curvatureError < tolerance, "runs either side of a cusp are C2");
+		expect(getDistance(smoothed[cusp - 1][2], path[cusp - 1][2]) == 0.0 && getDistance(smoothed[cusp][1], path[cusp][1]) == 0.0, "handles at a cusp don't move");
+	}
+}
+
+int main() {
+	testContinuity();
+	testCusp();
+
+	if (failures > 0) {
+		printf("%d path smoother checks failed\n", failures);
+		return 1;
+	}
+
+	printf("path smoother checks passed\n");
+	return 0;
+}
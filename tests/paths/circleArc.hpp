@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "velocityProfile/sinusoidalVelocityProfile.hpp"
+using namespace Pronounce;
+std::vector<std::pair<PathPlanner::BezierSegment, QSpeed>> CircleArc = {{PathPlanner::BezierSegment(
+PathPlanner::Point(82_in, 70_in),
+PathPlanner::Point(82_in, 76.6276_in),
+PathPlanner::Point(76.6276_in, 82_in),
+PathPlanner::Point(70_in, 82_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(70_in, 82_in),
+PathPlanner::Point(63.3724_in, 82_in),
+PathPlanner::Point(58_in, 76.6276_in),
+PathPlanner::Point(58_in, 70_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(58_in, 70_in),
+PathPlanner::Point(58_in, 63.3724_in),
+PathPlanner::Point(63.3724_in, 58_in),
+PathPlanner::Point(70_in, 58_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(70_in, 58_in),
+PathPlanner::Point(76.6276_in, 58_in),
+PathPlanner::Point(82_in, 63.3724_in),
+PathPlanner::Point(82_in, 70_in)
+,false),
+0.0},
+};
+// PathPlanner made path
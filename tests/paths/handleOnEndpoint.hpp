@@ -0,0 +1,13 @@
+#pragma once
+#include <vector>
+#include "velocityProfile/sinusoidalVelocityProfile.hpp"
+using namespace Pronounce;
+std::vector<std::pair<PathPlanner::BezierSegment, QSpeed>> HandleOnEndpoint = {{PathPlanner::BezierSegment(
+PathPlanner::Point(20_in, 20_in),
+PathPlanner::Point(20_in, 20_in),
+PathPlanner::Point(60_in, 20_in),
+PathPlanner::Point(60_in, 60_in)
+,false),
+0.0},
+};
+// PathPlanner made path
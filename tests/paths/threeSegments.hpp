@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include "velocityProfile/sinusoidalVelocityProfile.hpp"
+using namespace Pronounce;
+std::vector<std::pair<PathPlanner::BezierSegment, QSpeed>> ThreeSegments = {{PathPlanner::BezierSegment(
+PathPlanner::Point(12_in, 36_in),
+PathPlanner::Point(40_in, 36_in),
+PathPlanner::Point(60_in, 20_in),
+PathPlanner::Point(84_in, 24_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(84_in, 24_in),
+PathPlanner::Point(108_in, 28_in),
+PathPlanner::Point(120_in, 60_in),
+PathPlanner::Point(104_in, 84_in)
+,false),
+(40_in/second).getValue()},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(104_in, 84_in),
+PathPlanner::Point(120_in, 60_in),
+PathPlanner::Point(70_in, 70_in),
+PathPlanner::Point(48_in, 96_in)
+,true),
+0.0},
+};
+// PathPlanner made path
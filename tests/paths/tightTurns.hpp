@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "velocityProfile/sinusoidalVelocityProfile.hpp"
+using namespace Pronounce;
+std::vector<std::pair<PathPlanner::BezierSegment, QSpeed>> TightTurns = {{PathPlanner::BezierSegment(
+PathPlanner::Point(70_in, 10_in),
+PathPlanner::Point(70_in, 40_in),
+PathPlanner::Point(100_in, 40_in),
+PathPlanner::Point(100_in, 60_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(100_in, 60_in),
+PathPlanner::Point(100_in, 80_in),
+PathPlanner::Point(40_in, 60_in),
+PathPlanner::Point(40_in, 90_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(40_in, 90_in),
+PathPlanner::Point(40_in, 120_in),
+PathPlanner::Point(80_in, 130_in),
+PathPlanner::Point(75_in, 110_in)
+,false),
+0.0},
+{PathPlanner::BezierSegment(
+PathPlanner::Point(75_in, 110_in),
+PathPlanner::Point(70_in, 90_in),
+PathPlanner::Point(60_in, 100_in),
+PathPlanner::Point(55_in, 95_in)
+,false),
+0.0},
+};
+// PathPlanner made path
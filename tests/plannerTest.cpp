@@ -0,0 +1,207 @@
+// Planner limit tests, every path in the corpus is planned with each set of limits and the planned profiles must keep to
+// them. The golden files only pin what the planner used to do, these check that what it does is allowed.
+//
+// Usage: planner_test <path file>...
+
+#include "bezierSegment.hpp"
+#include "pathFile.hpp"
+#include "velocityPlanner.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Same robot as the editor plans for
+const PathPlanner::PlannerConstraints constraints{60_in/second, 100_in/second/second, 8_in};
+
+// The profiles are stored as floats in inches, a limit is kept if it is kept to within this fraction
+const double tolerance = 1.0e-3;
+
+// Fraction the two planning methods' durations can differ by
+const double methodTolerance = 0.01;
+
+int failures = 0;
+
+void expect(bool condition, const std::string& name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name.c_str());
+		failures++;
+	}
+}
+
+/**
+ * @brief Fail if the largest magnitude of a profile goes past its limit
+ */
+void expectWithin(const QuantityArray<QAcceleration>& profile, QAcceleration limit, const std::string& name) {
+	double worst = 0.0;
+
+	for (int i = 0; i < profile.size(); i++) {
+		worst = std::max(worst, fabs(profile.at(i).getValue()));
+	}
+
+	if (worst > limit.getValue() * (1.0 + tolerance)) {
+		printf("FAILED: %s reaches %.2f in/s^2, the limit is %.2f in/s^2\n", name.c_str(), QAcceleration(worst).Convert(inch/second/second), limit.Convert(inch/second/second));
+		failures++;
+	}
+}
+
+/**
+ * @brief Every acceleration limit of the constraints holds over the whole plan
+ */
+void checkLimits(std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& inverted, const PathPlanner::PlannerConstraints& limits, const std::string& name) {
+	PathPlanner::PlannedPath path = PathPlanner::VelocityPlanner(limits).calculate(segments, inverted);
+	QAcceleration maxWheelAcceleration = limits.maxWheelAcceleration.getValue() > 0.0 ? limits.maxWheelAcceleration : limits.maxAcceleration;
+
+	expect(path.size() > 1 && path.duration.getValue() > 0.0, name + " is planned");
+	expectWithin(path.accelerationByDistance, limits.maxAcceleration, name + " acceleration");
+	expectWithin(path.leftWheelAcceleration, maxWheelAcceleration, name + " left wheel acceleration");
+	expectWithin(path.rightWheelAcceleration, maxWheelAcceleration, name + " right wheel acceleration");
+
+	if (limits.maxLateralAcceleration.getValue() > 0.0) {
+		expectWithin(path.lateralAcceleration, limits.maxLateralAcceleration, name + " lateral acceleration");
+	}
+}
+
+/**
+ * @brief With adaptive samples the duration is within maxTimeError of the duration with samples far closer together
+ * than the error needs
+ *
+ * @param corners Whether the segments meet at an angle, the robot has to come closer to stopping there the closer the
+ * samples are so no spacing is within maxTimeError and the planner has to say so
+ */
+void checkTimeError(std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& inverted, const PathPlanner::PlannerConstraints& limits, bool corners, const std::string& name) {
+	PathPlanner::PlannerConstraints denseConstraints = limits;
+	denseConstraints.sampleSpacing = 0.02_in;
+
+	QTime reference = PathPlanner::VelocityPlanner(denseConstraints).calculate(segments, inverted).duration;
+
+	for (QTime maxTimeError : {0.005_s, 0.001_s}) {
+		PathPlanner::PlannerConstraints adaptiveConstraints = limits;
+		adaptiveConstraints.maxTimeError = maxTimeError;
+
+		PathPlanner::PlannedPath path = PathPlanner::VelocityPlanner(adaptiveConstraints).calculate(segments, inverted);
+		QTime error = fabs((path.duration - reference).getValue());
+
+		if (corners) {
+			expect(!path.withinTimeError, name + " adaptive samples report the corners aren't within maxTimeError");
+		} else if (!path.withinTimeError) {
+			expect(false, name + " adaptive samples report the time within maxTimeError");
+		} else if (error > maxTimeError) {
+			printf("FAILED: %s adaptive samples are %.4f s from the dense plan, the limit is %.4f s\n", name.c_str(), error.Convert(second), maxTimeError.Convert(second));
+			failures++;
+		}
+	}
+}
+
+/**
+ * @brief Duration of a plan with each method
+ */
+std::pair<QTime, QTime> getDurations(std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& inverted, const PathPlanner::PlannerConstraints& limits) {
+	PathPlanner::PlannerConstraints reachabilityConstraints = limits;
+	reachabilityConstraints.method = PathPlanner::PlannerMethod::Reachability;
+
+	return {
+			PathPlanner::VelocityPlanner(limits).calculate(segments, inverted).duration,
+			PathPlanner::VelocityPlanner(reachabilityConstraints).calculate(segments, inverted).duration};
+}
+
+/**
+ * @brief Both methods plan the same limits so their durations only differ by how each steps between samples, and a
+ * lateral limit can only slow either of them down
+ */
+void checkModes(std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& inverted, const PathPlanner::PlannerConstraints& lateralConstraints, const std::string& name) {
+	auto [twoPass, reachability] = getDurations(segments, inverted, constraints);
+	auto [lateralTwoPass, lateralReachability] = getDurations(segments, inverted, lateralConstraints);
+
+	expect(fabs((twoPass - reachability).getValue()) < methodTolerance * twoPass.getValue(), name + " two pass and reachability take the same time");
+	expect(fabs((lateralTwoPass - lateralReachability).getValue()) < methodTolerance * lateralTwoPass.getValue(), name + " friction circle two pass and reachability take the same time");
+	expect(lateralTwoPass.getValue() >= twoPass.getValue() * (1.0 - tolerance), name + " two pass lateral limit doesn't speed it up");
+	expect(lateralReachability.getValue() >= reachability.getValue() * (1.0 - tolerance), name + " reachability lateral limit doesn't speed it up");
+}
+
+/**
+ * @brief Plan a path with each of the planner's settings
+ */
+void checkPath(std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& inverted, bool corners, const std::string& name) {
+	checkLimits(segments, inverted, constraints, name + " two pass");
+	checkTimeError(segments, inverted, constraints, corners, name + " two pass");
+
+	// The editor's settings
+	PathPlanner::PlannerConstraints lateralConstraints = constraints;
+	lateralConstraints.maxLateralAcceleration = 100_in/second/second;
+	lateralConstraints.frictionCircle = true;
+
+	checkLimits(segments, inverted, lateralConstraints, name + " friction circle");
+	checkModes(segments, inverted, lateralConstraints, name);
+	checkTimeError(segments, inverted, lateralConstraints, corners, name + " friction circle");
+
+	PathPlanner::PlannerConstraints reachabilityConstraints = constraints;
+	reachabilityConstraints.method = PathPlanner::PlannerMethod::Reachability;
+
+	checkLimits(segments, inverted, reachabilityConstraints, name + " reachability");
+	checkTimeError(segments, inverted, reachabilityConstraints, corners, name + " reachability");
+
+	lateralConstraints.method = PathPlanner::PlannerMethod::Reachability;
+
+	checkLimits(segments, inverted, lateralConstraints, name + " reachability friction circle");
+	checkTimeError(segments, inverted, lateralConstraints, corners, name + " reachability friction circle");
+}
+
+/**
+ * @brief Segments alternating left and right with a right angle corner at every joint, the same path as the benchmark
+ */
+std::vector<PathPlanner::BezierSegment> getWindingPath(int count) {
+	std::vector<PathPlanner::BezierSegment> segments;
+
+	for (int i = 0; i < count; i++) {
+		double x = 24.0 * i;
+		double bend = (i % 2 == 0) ? 8.0 : -8.0;
+		segments.emplace_back(
+				PathPlanner::Point(x * 1_in, 0_in),
+				PathPlanner::Point((x + 8.0) * 1_in, bend * 1_in),
+				PathPlanner::Point((x + 16.0) * 1_in, -bend * 1_in),
+				PathPlanner::Point((x + 24.0) * 1_in, 0_in));
+	}
+
+	return segments;
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		std::ifstream pathFile(argv[i]);
+		std::string name;
+		std::vector<PathPlanner::PathFileSpline> splines;
+		PathPlanner::readPathFile(pathFile, name, splines);
+
+		expect(!splines.empty(), std::string(argv[i]) + " has splines");
+
+		std::vector<PathPlanner::BezierSegment> segments;
+		std::vector<bool> inverted;
+
+		for (auto &spline : splines) {
+			segments.emplace_back(
+					PathPlanner::Point(spline.points[0][0] * 1_in, spline.points[0][1] * 1_in),
+					PathPlanner::Point(spline.points[1][0] * 1_in, spline.points[1][1] * 1_in),
+					PathPlanner::Point(spline.points[2][0] * 1_in, spline.points[2][1] * 1_in),
+					PathPlanner::Point(spline.points[3][0] * 1_in, spline.points[3][1] * 1_in));
+			inverted.emplace_back(spline.inverted);
+		}
+
+		if (!segments.empty()) {
+			checkPath(segments, inverted, false, argv[i]);
+		}
+	}
+
+	std::vector<PathPlanner::BezierSegment> winding = getWindingPath(10);
+	checkPath(winding, std::vector<bool>(winding.size(), false), true, "winding path");
+
+	if (failures > 0) {
+		printf("%d planner checks failed\n", failures);
+		return 1;
+	}
+
+	printf("planner checks passed\n");
+	return 0;
+}
@@ -0,0 +1,105 @@
+// Reachability solver tests, every limit given to the solver has to hold on the speeds it comes back with, and with
+// only an acceleration limit the speeds have to be the known fastest profile
+//
+// Usage: reachability_solver_test
+
+#include "reachabilitySolver.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int failures = 0;
+
+void expect(bool condition, const char* name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name);
+		failures++;
+	}
+}
+
+/**
+ * @brief Accelerating and braking as hard as allowed, the squared speed goes up by 2 * a * ds from each end
+ */
+void testTriangleProfile() {
+	const double acceleration = 2.0;
+	const double maxSquaredSpeed = 3.0;
+	const int stages = 101;
+
+	std::vector<double> distances;
+	PathPlanner::ReachabilitySolver solver;
+
+	for (int i = 0; i < stages; i++) {
+		distances.emplace_back(i * 0.02);
+
+		solver.addStage(maxSquaredSpeed);
+		solver.addConstraint(1.0, 0.0, acceleration);
+		solver.addConstraint(-1.0, 0.0, acceleration);
+	}
+
+	std::vector<double> squaredSpeeds = solver.solve(distances);
+
+	double worst = 0.0;
+	for (int i = 0; i < stages; i++) {
+		double expected = std::min({maxSquaredSpeed, 2.0 * acceleration * distances[i], 2.0 * acceleration * (distances.back() - distances[i])});
+		worst = std::max(worst, fabs(squaredSpeeds[i] - expected));
+	}
+
+	expect(worst < 1.0e-9, "acceleration limit gives the triangle profile");
+	expect(solver.getMaxViolation(distances, squaredSpeeds) < 1.0e-9, "triangle profile keeps to its limits");
+}
+
+/**
+ * @brief Stages with random limits of every shape the planner uses, limits on u alone, on x alone and on both with
+ * either sign
+ */
+void testRandomLimits() {
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+	for (int problem = 0; problem < 200; problem++) {
+		int stages = 2 + random() % 200;
+
+		std::vector<double> distances = {0.0};
+		PathPlanner::ReachabilitySolver solver;
+
+		for (int i = 0; i < stages; i++) {
+			if (i > 0) {
+				// Some samples on top of each other
+				distances.emplace_back(distances.back() + (unit(random) < 0.05 ? 0.0 : 0.001 + 0.05 * unit(random)));
+			}
+
+			solver.addStage(4.0 * unit(random));
+			solver.addConstraint(1.0, 0.0, 2.5);
+			solver.addConstraint(-1.0, 0.0, 2.5);
+
+			for (int constraint = random() % 6; constraint > 0; constraint--) {
+				double acceleration = unit(random) < 0.2 ? 0.0 : 4.0 * unit(random) - 2.0;
+				solver.addConstraint(acceleration, 100.0 * unit(random) - 50.0, 5.0 * unit(random));
+			}
+		}
+
+		std::vector<double> squaredSpeeds = solver.solve(distances);
+
+		bool withinControllable = squaredSpeeds.front() == 0.0 && squaredSpeeds.back() == 0.0;
+		for (int i = 0; i < stages; i++) {
+			withinControllable = withinControllable && squaredSpeeds[i] >= 0.0 && squaredSpeeds[i] <= solver.getControllableMax(i);
+		}
+
+		expect(withinControllable, "random limits start and end at rest within the controllable speeds");
+		expect(solver.getMaxViolation(distances, squaredSpeeds) < 1.0e-9, "random limits hold on the solved speeds");
+	}
+}
+
+int main() {
+	testTriangleProfile();
+	testRandomLimits();
+
+	if (failures > 0) {
+		printf("%d reachability solver checks failed\n", failures);
+		return 1;
+	}
+
+	printf("reachability solver checks passed\n");
+	return 0;
+}
@@ -0,0 +1,145 @@
+// Trajectory compressor tests, interpolating between the kept samples by time has to stay within the tolerance of every
+// planned sample it skips, and the worst errors it reports have to be the ones it gets
+//
+// Usage: trajectory_compressor_test <path file>...
+
+#include "bezierSegment.hpp"
+#include "pathFile.hpp"
+#include "trajectoryCompressor.hpp"
+#include "velocityPlanner.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Same robot as the editor plans for
+const PathPlanner::PlannerConstraints constraints{60_in/second, 100_in/second/second, 8_in};
+
+// The channels are stored as floats, an error is within a tolerance if it is within it to this much
+const double floatTolerance = 1.0e-4;
+
+int failures = 0;
+
+void expect(bool condition, const std::string& name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name.c_str());
+		failures++;
+	}
+}
+
+/**
+ * @brief Worst difference between a channel and its linear interpolation by time between the knots
+ */
+double getMaxError(const QuantityArray<QTime>& time, const float* values, const std::vector<int>& knots) {
+	const float* seconds = time.view(second);
+	double maxError = 0.0;
+
+	for (size_t knot = 0; knot + 1 < knots.size(); knot++) {
+		int start = knots[knot];
+		int end = knots[knot + 1];
+		double duration = seconds[end] - seconds[start];
+
+		for (int sample = start; sample <= end; sample++) {
+			double fraction = duration > 0.0 ? (seconds[sample] - seconds[start]) / duration : 0.0;
+			double interpolated = values[start] + (values[end] - values[start]) * fraction;
+
+			maxError = std::max(maxError, fabs(values[sample] - interpolated));
+		}
+	}
+
+	return maxError;
+}
+
+/**
+ * @brief Compress a planned path and check every skipped sample against the tolerance
+ */
+void checkCompression(const PathPlanner::PlannedPath& path, const PathPlanner::CompressionTolerance& tolerance, const std::string& name) {
+	PathPlanner::CompressionResult result = PathPlanner::TrajectoryCompressor(tolerance).compress(path);
+	const std::vector<int>& knots = result.knots;
+
+	bool ordered = !knots.empty() && knots.front() == 0 && knots.back() == path.size() - 1;
+	for (size_t knot = 1; knot < knots.size(); knot++) {
+		ordered = ordered && knots[knot] > knots[knot - 1];
+	}
+
+	expect(ordered, name + " keeps the first and last sample and the knots in order");
+	expect(result.originalSamples == path.size() && result.getRatio() >= 1.0, name + " ratio is of the planned samples");
+
+	double distanceError = getMaxError(path.time, path.distanceTotal.view(inch), knots);
+	double velocityError = getMaxError(path.time, path.limitedSpeed.view(inch/second), knots);
+	double curvatureError = getMaxError(path.time, path.curvatureByDistance.view(degree/inch), knots);
+
+	expect(distanceError <= tolerance.distance.Convert(inch) + floatTolerance, name + " distance is within tolerance");
+	expect(velocityError <= tolerance.velocity.Convert(inch/second) + floatTolerance, name + " velocity is within tolerance");
+	expect(curvatureError <= tolerance.curvature.Convert(degree/inch) + floatTolerance, name + " curvature is within tolerance");
+
+	expect(fabs(result.maxDistanceError.Convert(inch) - distanceError) < floatTolerance
+			&& fabs(result.maxVelocityError.Convert(inch/second) - velocityError) < floatTolerance
+			&& fabs(result.maxCurvatureError.Convert(degree/inch) - curvatureError) < floatTolerance, name + " reports the errors it gets");
+}
+
+/**
+ * @brief Compress a path planned with each of the planner's settings at a loose and a tight tolerance
+ */
+void checkPath(std::vector<PathPlanner::BezierSegment>& segments, const std::vector<bool>& inverted, const std::string& name) {
+	PathPlanner::PlannerConstraints lateralConstraints = constraints;
+	lateralConstraints.maxLateralAcceleration = 100_in/second/second;
+	lateralConstraints.frictionCircle = true;
+
+	PathPlanner::CompressionTolerance tightTolerance;
+	tightTolerance.distance = 0.01_in;
+	tightTolerance.velocity = 0.05 * inch / second;
+	tightTolerance.curvature = 0.05 * degree / inch;
+
+	for (auto &limits : {constraints, lateralConstraints}) {
+		PathPlanner::PlannedPath path = PathPlanner::VelocityPlanner(limits).calculate(segments, inverted);
+
+		checkCompression(path, PathPlanner::CompressionTolerance(), name);
+		checkCompression(path, tightTolerance, name + " tight");
+
+		// Nothing is out of tolerance with every sample kept
+		std::vector<int> every;
+		for (int i = 0; i < path.size(); i++) {
+			every.emplace_back(i);
+		}
+
+		PathPlanner::CompressionResult all = PathPlanner::TrajectoryCompressor().measure(path, every);
+		expect(all.maxDistanceError.getValue() == 0.0 && all.maxVelocityError.getValue() == 0.0 && all.maxCurvatureError.getValue() == 0.0, name + " every sample kept has no error");
+	}
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		std::ifstream pathFile(argv[i]);
+		std::string name;
+		std::vector<PathPlanner::PathFileSpline> splines;
+		PathPlanner::readPathFile(pathFile, name, splines);
+
+		expect(!splines.empty(), std::string(argv[i]) + " has splines");
+
+		std::vector<PathPlanner::BezierSegment> segments;
+		std::vector<bool> inverted;
+
+		for (auto &spline : splines) {
+			segments.emplace_back(
+					PathPlanner::Point(spline.points[0][0] * 1_in, spline.points[0][1] * 1_in),
+					PathPlanner::Point(spline.points[1][0] * 1_in, spline.points[1][1] * 1_in),
+					PathPlanner::Point(spline.points[2][0] * 1_in, spline.points[2][1] * 1_in),
+					PathPlanner::Point(spline.points[3][0] * 1_in, spline.points[3][1] * 1_in));
+			inverted.emplace_back(spline.inverted);
+		}
+
+		if (!segments.empty()) {
+			checkPath(segments, inverted, argv[i]);
+		}
+	}
+
+	if (failures > 0) {
+		printf("%d trajectory compressor checks failed\n", failures);
+		return 1;
+	}
+
+	printf("trajectory compressor checks passed\n");
+	return 0;
+}
@@ -0,0 +1,226 @@
+// Golden output test for trajectory generation, computes the reference profiles of a path file and compares them against
+// a stored golden file so changes to the path math that change how the robot drives are caught. Only the reference
+// segment math and planner are pinned here, what the other planner modes, the followers, the smoother and the
+// compressor have to do is checked by their own tests.
+//
+// Usage: trajectory_golden_test <path file> <golden file> [--update]
+//
+// --update rewrites the golden file from the current output instead of comparing against it
+
+#include "bezierSegment.hpp"
+#include "pathFile.hpp"
+#include "sinusoidalVelocityProfile.hpp"
+#include "velocityPlanner.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// A value matches if it is within absoluteTolerance + relativeTolerance * |golden| of the golden value
+const double absoluteTolerance = 1.0e-3;
+const double relativeTolerance = 1.0e-4;
+
+// Same robot as the editor plans for
+const PathPlanner::PlannerConstraints constraints{60_in/second, 100_in/second/second, 8_in};
+
+/**
+ * @brief Write a line of a label followed by values
+ */
+void writeLine(std::ostringstream& output, const std::string& label, const std::vector<double>& values) {
+	output << label;
+
+	char buffer[32];
+	for (auto &value : values) {
+		snprintf(buffer, sizeof(buffer), " %.9g", value);
+		output << buffer;
+	}
+
+	output << "\n";
+}
+
+/**
+ * @brief Every profile of a path as text, one quantity per line
+ */
+std::string computeProfiles(std::vector<PathPlanner::PathFileSpline>& splines) {
+	std::ostringstream output;
+
+	std::vector<PathPlanner::BezierSegment> segments;
+	std::vector<bool> inverted;
+
+	for (auto &spline : splines) {
+		segments.emplace_back(
+				PathPlanner::Point(spline.points[0][0] * 1_in, spline.points[0][1] * 1_in),
+				PathPlanner::Point(spline.points[1][0] * 1_in, spline.points[1][1] * 1_in),
+				PathPlanner::Point(spline.points[2][0] * 1_in, spline.points[2][1] * 1_in),
+				PathPlanner::Point(spline.points[3][0] * 1_in, spline.points[3][1] * 1_in));
+		inverted.emplace_back(spline.inverted);
+	}
+
+	writeLine(output, "segments", {(double) segments.size()});
+
+	for (size_t i = 0; i < segments.size(); i++) {
+		std::string label = "segment " + std::to_string(i);
+		PathPlanner::BezierSegment& segment = segments.at(i);
+
+		writeLine(output, label + " length", {segment.getDistance().Convert(inch)});
+
+		std::vector<double> curvature;
+		std::vector<double> tByLength;
+
+		for (int sample = 0; sample <= 8; sample++) {
+			curvature.emplace_back(segment.getCurvature(sample / 8.0).Convert(degree/inch));
+			tByLength.emplace_back(segment.getTByLength((sample / 8.0) * segment.getDistance()));
+		}
+
+		writeLine(output, label + " curvature", curvature);
+		writeLine(output, label + " tByLength", tByLength);
+
+		Pronounce::SinusoidalVelocityProfile profile(segment.getDistance(), constraints.maxSpeed, constraints.maxAcceleration, 0.0);
+		profile.calculate(100);
+
+		std::vector<double> velocity;
+
+		for (int sample = 0; sample <= 10; sample++) {
+			velocity.emplace_back(profile.getVelocityByTime((sample / 10.0) * profile.getDuration()).Convert(inch/second));
+		}
+
+		writeLine(output, label + " sinusoidalDuration", {profile.getDuration().Convert(second)});
+		writeLine(output, label + " sinusoidalVelocity", velocity);
+	}
+
+	PathPlanner::PlannedPath plannedPath = PathPlanner::VelocityPlanner(constraints).calculate(segments, inverted);
+
+	writeLine(output, "length", {plannedPath.length.Convert(inch)});
+	writeLine(output, "duration", {plannedPath.duration.Convert(second)});
+
+	for (int i = 0; i < plannedPath.size(); i++) {
+		writeLine(output, "sample " + std::to_string(i), {
+				plannedPath.distanceTotal.at(i).Convert(inch),
+				plannedPath.limitedSpeed.at(i).Convert(inch/second),
+				plannedPath.curvatureByDistance.at(i).Convert(degree/inch),
+				plannedPath.time.at(i).Convert(second)});
+	}
+
+	return output.str();
+}
+
+/**
+ * @brief Compare the output against the golden file token by token, labels have to match exactly and numbers within
+ * the tolerances
+ *
+ * @return int Number of mismatches
+ */
+int compare(const std::string& actual, const std::string& golden) {
+	std::istringstream actualLines(actual);
+	std::istringstream goldenLines(golden);
+	std::string actualLine, goldenLine;
+
+	int mismatches = 0;
+	int lineNumber = 0;
+
+	while (true) {
+		bool hasActual = (bool) getline(actualLines, actualLine);
+		bool hasGolden = (bool) getline(goldenLines, goldenLine);
+		lineNumber++;
+
+		if (!hasActual && !hasGolden) {
+			return mismatches;
+		}
+
+		if (hasActual != hasGolden) {
+			fprintf(stderr, "line %d: %s\n", lineNumber, hasActual ? "extra output" : "missing output");
+			return mismatches + 1;
+		}
+
+		std::istringstream actualTokens(actualLine);
+		std::istringstream goldenTokens(goldenLine);
+		std::string actualToken, goldenToken;
+
+		while (true) {
+			bool hasActualToken = (bool) (actualTokens >> actualToken);
+			bool hasGoldenToken = (bool) (goldenTokens >> goldenToken);
+
+			if (!hasActualToken && !hasGoldenToken) {
+				break;
+			}
+
+			char* actualEnd;
+			char* goldenEnd;
+			double actualValue = hasActualToken ? strtod(actualToken.c_str(), &actualEnd) : 0.0;
+			double goldenValue = hasGoldenToken ? strtod(goldenToken.c_str(), &goldenEnd) : 0.0;
+
+			bool matches;
+
+			if (!hasActualToken || !hasGoldenToken) {
+				matches = false;
+			} else if (*actualEnd == '\0' && *goldenEnd == '\0') {
+				// NaN and infinity have to match exactly, they are part of the reference behavior too
+				matches = (std::isnan(actualValue) && std::isnan(goldenValue))
+						|| actualValue == goldenValue
+						|| fabs(actualValue - goldenValue) <= absoluteTolerance + relativeTolerance * fabs(goldenValue);
+			} else {
+				matches = actualToken == goldenToken;
+			}
+
+			if (!matches) {
+				if (mismatches < 20) {
+					fprintf(stderr, "line %d: expected \"%s\"\n         got      \"%s\"\n", lineNumber, goldenLine.c_str(), actualLine.c_str());
+				}
+				mismatches++;
+				break;
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3 || (argc == 4 && strcmp(argv[3], "--update") != 0) || argc > 4) {
+		fprintf(stderr, "Usage: %s <path file> <golden file> [--update]\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream pathFile(argv[1]);
+	if (!pathFile) {
+		fprintf(stderr, "Couldn't open %s\n", argv[1]);
+		return 1;
+	}
+
+	std::string name;
+	std::vector<PathPlanner::PathFileSpline> splines;
+	PathPlanner::readPathFile(pathFile, name, splines);
+
+	if (splines.empty()) {
+		fprintf(stderr, "%s has no splines\n", argv[1]);
+		return 1;
+	}
+
+	std::string actual = computeProfiles(splines);
+
+	if (argc == 4) {
+		std::ofstream goldenFile(argv[2]);
+		goldenFile << actual;
+		return goldenFile ? 0 : 1;
+	}
+
+	std::ifstream goldenFile(argv[2]);
+	if (!goldenFile) {
+		fprintf(stderr, "Couldn't open %s, run with --update to create it\n", argv[2]);
+		return 1;
+	}
+
+	std::stringstream golden;
+	golden << goldenFile.rdbuf();
+
+	int mismatches = compare(actual, golden.str());
+
+	if (mismatches > 0) {
+		fprintf(stderr, "%s: %d lines differ from %s\n", argv[1], mismatches, argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
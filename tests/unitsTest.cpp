@@ -0,0 +1,92 @@
+// Quantity array tests, arrays in different units of the same quantity have to add up to the right quantities and a
+// product of arrays has to come out as the right quantity in the product of their units
+//
+// Usage: units_test
+
+#include "units.hpp"
+#include <cmath>
+#include <cstdio>
+
+// The numbers are stored as floats
+const double tolerance = 1.0e-6;
+
+int failures = 0;
+
+void expect(bool condition, const char* name) {
+	if (!condition) {
+		printf("FAILED: %s\n", name);
+		failures++;
+	}
+}
+
+bool near(double actual, double expected) {
+	return fabs(actual - expected) <= tolerance * std::max(1.0, fabs(expected));
+}
+
+/**
+ * @brief Inches plus metres is in inches and minus metres takes the same amount back off
+ */
+void testMixedUnitAdd() {
+	QuantityArray<QLength> inches(inch, 3);
+	QuantityArray<QLength> metres(metre, 3);
+
+	for (int i = 0; i < 3; i++) {
+		inches.set(i, (i + 1) * 1_in);
+		metres.set(i, (i + 1) * 1_m);
+	}
+
+	QuantityArray<QLength> sum = inches + metres;
+	QuantityArray<QLength> difference = sum - metres;
+
+	bool added = sum.getUnit().getValue() == inch.getValue();
+	bool subtracted = true;
+	for (int i = 0; i < 3; i++) {
+		added = added && near(sum[i].Convert(inch), (i + 1) * (1.0 + 1.0 / 0.0254));
+		subtracted = subtracted && near(difference[i].Convert(inch), i + 1);
+	}
+
+	expect(added, "inches plus metres adds the lengths in inches");
+	expect(subtracted, "taking the metres back off leaves the inches");
+	expect(near(metres.to(inch).data()[2], 3.0 / 0.0254) && near(metres.to(inch)[2].Convert(metre), 3.0), "metres in inches are the same lengths");
+}
+
+/**
+ * @brief Inches per second times seconds is a length in inches, and squared speed times curvature an acceleration
+ */
+void testProductUnitMultiply() {
+	QuantityArray<QSpeed> speed(inch/second, 3);
+	QuantityArray<QTime> time(second, 3);
+	QuantityArray<decltype(Number() / QLength())> curvature(Number(1.0) / metre, 3);
+
+	for (int i = 0; i < 3; i++) {
+		speed.set(i, (i + 1) * 10.0 * inch/second);
+		time.set(i, (i + 1) * 0.5_s);
+		curvature.set(i, 2.0 / metre);
+	}
+
+	QuantityArray<QLength> distance = speed * time;
+	QuantityArray<QAcceleration> lateral = (speed * speed * curvature).to(inch/second/second);
+
+	bool multiplied = near(distance.getUnit().getValue(), inch.getValue());
+	bool squared = true;
+	for (int i = 0; i < 3; i++) {
+		multiplied = multiplied && near(distance[i].Convert(inch), (i + 1) * (i + 1) * 5.0);
+		squared = squared && near(lateral[i].Convert(inch/second/second), (i + 1) * (i + 1) * 100.0 * 2.0 * 0.0254);
+	}
+
+	expect(multiplied, "speed times time is the distance in inches");
+	expect(squared, "speed squared times curvature is the acceleration");
+}
+
+int main() {
+	testMixedUnitAdd();
+	testProductUnitMultiply();
+
+	if (failures > 0) {
+		printf("%d units checks failed\n", failures);
+		return 1;
+	}
+
+	printf("units checks passed\n");
+	return 0;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "velocityPlanner.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief Largest difference allowed between a channel and its linear interpolation between the kept samples
+	 */
+	struct CompressionTolerance {
+		QLength distance = 0.1_in;
+		QSpeed velocity = 0.5 * inch / second;
+		QCurvature curvature = 0.5 * degree / inch;
+	};
+
+	/**
+	 * @brief Samples kept by a compression and how far the interpolated channels get from the planned ones
+	 */
+	struct CompressionResult {
+		/**
+		 * @brief Indices of the kept samples in increasing order, the first and last sample are always kept
+		 */
+		std::vector<int> knots;
+
+		int originalSamples = 0;
+
+		QLength maxDistanceError = 0.0;
+		QSpeed maxVelocityError = 0.0;
+		QCurvature maxCurvatureError = 0.0;
+
+		/**
+		 * @brief Planned samples per kept sample
+		 */
+		double getRatio() const {
+			return knots.empty() ? 1.0 : (double) originalSamples / (double) knots.size();
+		}
+	};
+
+	/**
+	 * @brief Picks the samples of a planned path to export so interpolating between them stays within a tolerance
+	 *
+	 * The robot looks the profile up by time, so distance, velocity and curvature are treated as functions of time and
+	 * every channel shares the same knots, each exported row stays a whole sample. Knots are picked Douglas-Peucker
+	 * style, a span is split at the sample that is furthest out of tolerance in any channel until no sample is.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class TrajectoryCompressor {
+	private:
+		CompressionTolerance tolerance;
+
+		/**
+		 * @brief The channels in the units they are stored in, with each tolerance in the same units
+		 */
+		struct Channels {
+			const float* time;
+			const float* values[3];
+			float tolerances[3];
+		};
+
+		Channels getChannels(const PlannedPath& plannedPath) const {
+			return {
+					plannedPath.time.view(second),
+					{plannedPath.distanceTotal.view(inch), plannedPath.limitedSpeed.view(inch/second), plannedPath.curvatureByDistance.view(degree/inch)},
+					{(float) tolerance.distance.Convert(inch), (float) tolerance.velocity.Convert(inch/second), (float) tolerance.curvature.Convert(degree/inch)}
+			};
+		}
+
+		/**
+		 * @brief Difference of a sample from the line between two knots, in each channel
+		 */
+		static void getErrors(const Channels& channels, int start, int end, int sample, float errors[3]) {
+			float duration = channels.time[end] - channels.time[start];
+			float fraction = duration > 0.0f ? (channels.time[sample] - channels.time[start]) / duration : 0.0f;
+
+			for (int channel = 0; channel < 3; channel++) {
+				const float* values = channels.values[channel];
+				float interpolated = values[start] + (values[end] - values[start]) * fraction;
+
+				errors[channel] = fabs(values[sample] - interpolated);
+			}
+		}
+
+	public:
+		/**
+		 * @brief Construct a new Trajectory Compressor
+		 *
+		 * @param tolerance Largest interpolation error allowed in each channel, a tolerance of 0 keeps every sample that
+		 * isn't exactly on the line
+		 */
+		explicit TrajectoryCompressor(CompressionTolerance tolerance = {}) : tolerance(tolerance) {}
+
+		/**
+		 * @brief Pick the samples to keep
+		 */
+		CompressionResult compress(const PlannedPath& plannedPath) const {
+			int samples = plannedPath.size();
+
+			if (samples == 0) {
+				return measure(plannedPath, {});
+			}
+
+			Channels channels = getChannels(plannedPath);
+			std::vector<bool> kept(samples, false);
+			kept.front() = true;
+			kept.back() = true;
+
+			// Spans still to check, a stack instead of recursion so long skills routes can't run out of stack
+			std::vector<std::pair<int, int>> spans;
+			if (samples > 2) {
+				spans.emplace_back(0, samples - 1);
+			}
+
+			while (!spans.empty()) {
+				auto [start, end] = spans.back();
+				spans.pop_back();
+
+				int worst = -1;
+				float worstScore = 1.0f;
+
+				for (int sample = start + 1; sample < end; sample++) {
+					float errors[3];
+					getErrors(channels, start, end, sample, errors);
+
+					// Out of tolerance in the channel that is furthest out, relative to its own tolerance
+					for (int channel = 0; channel < 3; channel++) {
+						float score = channels.tolerances[channel] > 0.0f ? errors[channel] / channels.tolerances[channel] : (errors[channel] > 0.0f ? INFINITY : 0.0f);
+
+						if (score > worstScore) {
+							worstScore = score;
+							worst = sample;
+						}
+					}
+				}
+
+				if (worst < 0) {
+					continue;
+				}
+
+				kept[worst] = true;
+
+				if (worst - start > 1) {
+					spans.emplace_back(start, worst);
+				}
+				if (end - worst > 1) {
+					spans.emplace_back(worst, end);
+				}
+			}
+
+			std::vector<int> knots;
+
+			for (int sample = 0; sample < samples; sample++) {
+				if (kept[sample]) {
+					knots.emplace_back(sample);
+				}
+			}
+
+			return measure(plannedPath, std::move(knots));
+		}
+
+		/**
+		 * @brief The worst errors of interpolating between a set of samples, measured at every sample in between
+		 *
+		 * @param plannedPath The planned path the samples are from
+		 * @param knots Indices of the samples in increasing order
+		 */
+		CompressionResult measure(const PlannedPath& plannedPath, std::vector<int> knots) const {
+			CompressionResult result;
+			result.originalSamples = plannedPath.size();
+			result.knots = std::move(knots);
+
+			if (result.knots.empty()) {
+				return result;
+			}
+
+			Channels channels = getChannels(plannedPath);
+			float maxErrors[3] = {0.0f, 0.0f, 0.0f};
+
+			for (size_t knot = 0; knot + 1 < result.knots.size(); knot++) {
+				for (int sample = result.knots[knot] + 1; sample < result.knots[knot + 1]; sample++) {
+					float errors[3];
+					getErrors(channels, result.knots[knot], result.knots[knot + 1], sample, errors);
+
+					for (int channel = 0; channel < 3; channel++) {
+						maxErrors[channel] = std::max(maxErrors[channel], errors[channel]);
+					}
+				}
+			}
+
+			result.maxDistanceError = maxErrors[0] * inch;
+			result.maxVelocityError = maxErrors[1] * inch / second;
+			result.maxCurvatureError = maxErrors[2] * degree / inch;
+
+			return result;
+		}
+	};
+} // namespace PathPlanner
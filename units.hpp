@@ -4,6 +4,9 @@
 
 #include <ratio>
 #include <math.h>
+#include <cassert>
+#include <cstddef>
+#include <vector>
 
 // The "RQuantity" class is the prototype template container class, that just holds a double value. The
 // class SHOULD NOT BE INSTANTIATED directly by itself, rather use the quantity types defined below.
@@ -415,3 +418,106 @@ inline double cos(const Angle& num) {
 inline double tan(const Angle& num) {
 	return tan(num.getValue());
 }
+
+// Sign of a raw value, -1, 0 or 1
+inline int signnum_c(double x) {
+	if (x > 0.0) return 1;
+	if (x < 0.0) return -1;
+	return 0;
+}
+
+
+// Arrays of quantities:
+// ---------------------
+
+// Contiguous array of one quantity type stored as plain numbers in multiples of a unit chosen at construction, so bulk
+// data keeps its unit without storing a quantity per element. Element access converts, data() and view() hand the raw
+// numbers to code like ImPlot without a copy, and element-wise arithmetic is a plain loop over the numbers that the
+// compiler can vectorize. Arrays in different units of the same quantity can be mixed, the right hand side is scaled.
+template<typename Q, typename Scalar = float>
+class QuantityArray
+{
+private:
+	std::vector<Scalar> values;
+	Q unit;
+
+public:
+	explicit QuantityArray(Q unit = Q(1.0), size_t size = 0) : values(size), unit(unit) {}
+
+	size_t size() const { return values.size(); }
+	bool empty() const { return values.empty(); }
+
+	void resize(size_t size) { values.resize(size); }
+	void clear() { values.clear(); }
+
+	// The unit the raw numbers are in
+	Q getUnit() const { return unit; }
+
+	Q operator[](size_t i) const { return Q(values[i] * unit.getValue()); }
+	Q at(size_t i) const { return Q(values.at(i) * unit.getValue()); }
+	Q front() const { return at(0); }
+	Q back() const { return at(values.size() - 1); }
+
+	void set(size_t i, const Q& value) { values[i] = static_cast<Scalar>(value.getValue() / unit.getValue()); }
+
+	// Raw numbers in multiples of getUnit()
+	Scalar* data() { return values.data(); }
+	const Scalar* data() const { return values.data(); }
+
+	// Raw numbers for a caller that expects them in a unit, checked against the unit they are stored in
+	const Scalar* view(const Q& expectedUnit) const
+	{
+		assert(fabs(expectedUnit.getValue() - unit.getValue()) <= 1e-12 * fabs(unit.getValue()));
+		return values.data();
+	}
+
+	// Copy in another unit of the same quantity
+	QuantityArray to(const Q& newUnit) const
+	{
+		QuantityArray result(newUnit, values.size());
+		Scalar scale = static_cast<Scalar>(unit.getValue() / newUnit.getValue());
+		for (size_t i = 0; i < values.size(); i++) result.values[i] = values[i] * scale;
+		return result;
+	}
+
+	QuantityArray& operator+=(const QuantityArray& rhs)
+	{
+		assert(rhs.size() == size());
+		Scalar scale = static_cast<Scalar>(rhs.unit.getValue() / unit.getValue());
+		for (size_t i = 0; i < values.size(); i++) values[i] += rhs.values[i] * scale;
+		return *this;
+	}
+	QuantityArray& operator-=(const QuantityArray& rhs)
+	{
+		assert(rhs.size() == size());
+		Scalar scale = static_cast<Scalar>(rhs.unit.getValue() / unit.getValue());
+		for (size_t i = 0; i < values.size(); i++) values[i] -= rhs.values[i] * scale;
+		return *this;
+	}
+
+	template<typename, typename> friend class QuantityArray;
+};
+
+template <typename Q, typename S>
+QuantityArray<Q, S> operator+(QuantityArray<Q, S> lhs, const QuantityArray<Q, S>& rhs)
+{
+	return lhs += rhs;
+}
+template <typename Q, typename S>
+QuantityArray<Q, S> operator-(QuantityArray<Q, S> lhs, const QuantityArray<Q, S>& rhs)
+{
+	return lhs -= rhs;
+}
+
+// The unit of a product is the product of the units, so the raw numbers are multiplied as they are
+template <typename Q1, typename Q2, typename S>
+QuantityArray<decltype(Q1() * Q2()), S> operator*(const QuantityArray<Q1, S>& lhs, const QuantityArray<Q2, S>& rhs)
+{
+	assert(lhs.size() == rhs.size());
+	QuantityArray<decltype(Q1() * Q2()), S> result(lhs.getUnit() * rhs.getUnit(), lhs.size());
+	S* out = result.data();
+	const S* a = lhs.data();
+	const S* b = rhs.data();
+	for (size_t i = 0; i < lhs.size(); i++) out[i] = a[i] * b[i];
+	return result;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+#include "point.hpp"
+#include "vector.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief A 2d vector stored as x and y in meters
+	 *
+	 * Vector keeps a magnitude and an angle, so every sum, dot product or conversion to Point costs a sin and a cos.
+	 * Vec2 is plain cartesian math that is all constexpr, and it is aligned so the compiler can keep both components in
+	 * one SSE2 register and do the pair of them in one instruction.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	struct alignas(16) Vec2 {
+		double x{0.0};
+		double y{0.0};
+
+		constexpr Vec2() = default;
+
+		constexpr Vec2(double x, double y) : x(x), y(y) {}
+
+		/**
+		 * @brief Construct a Vec2 from a point, the point is taken as a vector from the origin
+		 */
+		explicit Vec2(Point point) : x(point.getX().getValue()), y(point.getY().getValue()) {}
+
+		/**
+		 * @brief Construct a Vec2 from a vector, the one place the sin and cos are paid
+		 */
+		explicit Vec2(Vector vector) : Vec2(fromPolar(vector.getMagnitude().getValue(), vector.getAngle().getValue())) {}
+
+		static Vec2 fromPolar(double magnitude, double angle) {
+			return {magnitude * cos(angle), magnitude * sin(angle)};
+		}
+
+		Point toPoint() const {
+			return {x * metre, y * metre};
+		}
+
+		Vector toVector() const {
+			return {getLength() * metre, atan2(y, x) * radian};
+		}
+
+		constexpr Vec2 operator+(Vec2 other) const {
+			return {x + other.x, y + other.y};
+		}
+
+		constexpr Vec2 operator-(Vec2 other) const {
+			return {x - other.x, y - other.y};
+		}
+
+		constexpr Vec2 operator-() const {
+			return {-x, -y};
+		}
+
+		constexpr Vec2 operator*(double scalar) const {
+			return {x * scalar, y * scalar};
+		}
+
+		constexpr Vec2 operator/(double scalar) const {
+			return {x / scalar, y / scalar};
+		}
+
+		constexpr Vec2& operator+=(Vec2 other) {
+			x += other.x;
+			y += other.y;
+			return *this;
+		}
+
+		constexpr Vec2& operator-=(Vec2 other) {
+			x -= other.x;
+			y -= other.y;
+			return *this;
+		}
+
+		constexpr Vec2& operator*=(double scalar) {
+			x *= scalar;
+			y *= scalar;
+			return *this;
+		}
+
+		constexpr bool operator==(Vec2 other) const {
+			return x == other.x && y == other.y;
+		}
+
+		constexpr bool operator!=(Vec2 other) const {
+			return !(*this == other);
+		}
+
+		constexpr double dot(Vec2 other) const {
+			return x * other.x + y * other.y;
+		}
+
+		/**
+		 * @brief Z component of the 3d cross product, positive when other is counterclockwise of this
+		 */
+		constexpr double cross(Vec2 other) const {
+			return x * other.y - y * other.x;
+		}
+
+		constexpr double getLengthSquared() const {
+			return dot(*this);
+		}
+
+		double getLength() const {
+			return sqrt(getLengthSquared());
+		}
+
+		/**
+		 * @brief The vector scaled to length 1, a zero vector stays zero
+		 */
+		Vec2 normalized() const {
+			double length = getLength();
+
+			return length > 0.0 ? *this / length : Vec2();
+		}
+
+		/**
+		 * @brief The vector turned 90 degrees counterclockwise
+		 */
+		constexpr Vec2 perpendicular() const {
+			return {-y, x};
+		}
+	};
+
+	constexpr Vec2 operator*(double scalar, Vec2 vector) {
+		return vector * scalar;
+	}
+
+	static_assert(std::is_trivially_copyable<Vec2>::value, "Vec2 is copied around by value in the hot loops");
+	static_assert(sizeof(Vec2) == 16 && alignof(Vec2) == 16, "Vec2 is packed into one SSE2 register");
+} // namespace PathPlanner
@@ -0,0 +1,818 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "bezierSegment.hpp"
+#include "reachabilitySolver.hpp"
+#include "units.hpp"
+
+namespace PathPlanner {
+
+	/**
+	 * @brief How the speeds along the path are worked out from the limits
+	 */
+	enum class PlannerMethod {
+		/**
+		 * @brief Forward and backward passes that limit each sample by the one next to it
+		 */
+		TwoPass,
+
+		/**
+		 * @brief Time optimal speeds by reachability analysis with ReachabilitySolver, the wheel and friction circle
+		 * limits are exact instead of taken at the worst case
+		 */
+		Reachability
+	};
+
+	/**
+	 * @brief Robot limits used when planning speeds along a path
+	 */
+	struct PlannerConstraints {
+		QSpeed maxSpeed;
+		QAcceleration maxAcceleration;
+		QLength trackWidth;
+
+		/**
+		 * @brief Fastest a single wheel can turn, 0 uses maxSpeed
+		 */
+		QSpeed maxWheelSpeed = 0.0;
+
+		/**
+		 * @brief Hardest a single wheel can accelerate, 0 uses maxAcceleration
+		 */
+		QAcceleration maxWheelAcceleration = 0.0;
+
+		/**
+		 * @brief Most sideways acceleration before the robot slips or tips, 0 for no limit
+		 */
+		QAcceleration maxLateralAcceleration = 0.0;
+
+		/**
+		 * @brief Share maxLateralAcceleration between turning and speeding up, the total of both can't go past it
+		 */
+		bool frictionCircle = false;
+
+		/**
+		 * @brief Most the time of the whole path can be off by from where the samples are placed, samples go where the
+		 * speed limit changes instead of evenly. 0 samples evenly every sampleSpacing. PlannedPath::withinTimeError is
+		 * false where the samples can't get close enough for it.
+		 */
+		QTime maxTimeError = 0.0;
+
+		PlannerMethod method = PlannerMethod::TwoPass;
+
+		/**
+		 * @brief Distance between samples without maxTimeError, rounded so they come out even over the path
+		 */
+		QLength sampleSpacing = 1_in;
+	};
+
+	/**
+	 * @brief Sampled result of the forward/backward pass, stored as float arrays in inches, seconds and degrees so it
+	 * can be plotted directly
+	 */
+	struct PlannedPath {
+		QLength length = 0.0;
+		QTime duration = 0.0;
+		int granularity = 0;
+
+		/**
+		 * @brief False when adaptive samples got down to the smallest spacing with the time still further than
+		 * maxTimeError from where it would be with more of them
+		 */
+		bool withinTimeError = true;
+
+		/**
+		 * @brief Curvature the robot drives at every sample, the path's curvature averaged over an inch either side so
+		 * jumps at joints are blended in
+		 */
+		QuantityArray<QCurvature> curvatureByDistance{degree/inch};
+		QuantityArray<QSpeed> maxSpeedByDistance{inch/second};
+		QuantityArray<QSpeed> limitedSpeedLeft{inch/second};
+		QuantityArray<QSpeed> limitedSpeedRight{inch/second};
+		QuantityArray<QSpeed> limitedSpeed{inch/second};
+		QuantityArray<QTime> time{second};
+		QuantityArray<QLength> distanceTotal{inch};
+		QuantityArray<QAcceleration> accelerationByDistance{inch/second/second};
+
+		/**
+		 * @brief Position of every sample on the field
+		 */
+		QuantityArray<QLength> positionX{inch};
+		QuantityArray<QLength> positionY{inch};
+
+		/**
+		 * @brief Direction the robot faces at every sample, the same way BezierSegment::getAngle measures it, turned
+		 * around on inverted segments. The heading goes up by the curvature per unit of distance.
+		 */
+		QuantityArray<Angle> heading{degree};
+
+		/**
+		 * @brief Speed and acceleration of each side of the drive, positive is forwards for the robot
+		 */
+		QuantityArray<QSpeed> leftWheelSpeed{inch/second};
+		QuantityArray<QSpeed> rightWheelSpeed{inch/second};
+		QuantityArray<QAcceleration> leftWheelAcceleration{inch/second/second};
+		QuantityArray<QAcceleration> rightWheelAcceleration{inch/second/second};
+
+		/**
+		 * @brief Sideways acceleration of the center of the robot, v^2 * k
+		 */
+		QuantityArray<QAcceleration> lateralAcceleration{inch/second/second};
+
+		/**
+		 * @brief Number of samples in each array, one more than granularity. The samples are only evenly spaced without
+		 * adaptive sampling, distanceTotal has where each of them is.
+		 */
+		int size() const {
+			return granularity + 1;
+		}
+	};
+
+	/**
+	 * @brief Two pass speed limiter, samples a chain of bezier segments and limits the speed by curvature and
+	 * acceleration going forwards and backwards
+	 *
+	 * Samples are sampleSpacing apart, an inch unless set, or with a maxTimeError they are placed adaptively.
+	 * Acceleration between samples is constant, which is exact where the robot is limited by acceleration, so samples
+	 * are only needed where the speed limit bends. Each segment starts with samples maxSpacing apart and an interval is
+	 * halved while the time over it with the speed limit taken as linear between its ends is further from Simpson's rule
+	 * than its share of maxTimeError. The passes are then run and every interval checked against its share again, with
+	 * the passes rerun on the halved intervals until all of them are within it or minSpacing apart. Long straights get a
+	 * sample every maxSpacing and tight turns get them down to minSpacing apart.
+	 *
+	 * The robot is a differential drive, the outer wheel on a curve goes faster and accelerates harder than the center
+	 * of the robot, so both the speed and acceleration limits at a sample are lowered until both wheels are within
+	 * the wheel limits over the step to it. The passes work on flat arrays of samples so everything but the two passes themselves is a
+	 * simple loop the compiler can vectorize.
+	 *
+	 * With PlannerMethod::Reachability the two passes are replaced by ReachabilitySolver, which gives the fastest speeds
+	 * the limits allow between the samples rather than a safe guess at them.
+	 *
+	 * @authors Alex Dickhans
+	 */
+	class VelocityPlanner {
+	private:
+		PlannerConstraints constraints;
+
+		static constexpr double maxSpacing = 6.0 * 0.0254;
+		static constexpr double minSpacing = 1.0 / 32.0 * 0.0254;
+		static constexpr double curvatureWindow = 1.0 * 0.0254;
+		static constexpr int frictionCircleEdges = 8;
+		static constexpr int frictionCircleIterations = 20;
+
+		/**
+		 * @brief Time to cover distance going from one speed to another at a constant acceleration
+		 */
+		static double getDuration(double lastSpeed, double speed, double distance) {
+			double sum = fabs(lastSpeed + speed);
+
+			return sum > 0.0 ? 2.0 * distance / sum : 0.0;
+		}
+
+		/**
+		 * @brief Direction the robot faces in radians at a distance along the path in meters, turned around on inverted
+		 * segments so it doesn't flip where the robot stops and backs up. segmentStarts has the distance each segment
+		 * starts at and the length of the path at the end.
+		 */
+		static double getHeadingAt(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const std::vector<double>& segmentStarts, double distance) {
+			int segment = std::clamp((int) (std::upper_bound(segmentStarts.begin(), segmentStarts.end() - 1, distance) - segmentStarts.begin()) - 1, 0, (int) segments.size() - 1);
+			double heading = segments.at(segment).getAngle(segments.at(segment).getTByLength((distance - segmentStarts[segment]) * metre)).getValue();
+
+			return segment < (int) inverted.size() && inverted.at(segment) ? heading + M_PI : heading;
+		}
+
+		/**
+		 * @brief Curvature the robot drives at a distance, the change in heading over curvatureWindow either side over
+		 * the distance it changes in
+		 *
+		 * The wheels can't change speed instantly, so neither can the curvature. Where it jumps at a joint the robot
+		 * blends it in over the window, and the heading change is the exact average of the curvature over it. Samples
+		 * closer together than the window then see the curvature change by their spacing times a finite slope, so the
+		 * speed at a joint doesn't depend on where the samples are.
+		 */
+		static double getCurvatureAt(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const std::vector<double>& segmentStarts, double distance) {
+			double before = std::max(0.0, distance - curvatureWindow);
+			double after = std::min(segmentStarts.back(), distance + curvatureWindow);
+
+			// A path without length doesn't turn
+			if (after <= before) {
+				return 0.0;
+			}
+
+			return remainder(getHeadingAt(segments, inverted, segmentStarts, after) - getHeadingAt(segments, inverted, segmentStarts, before), 2.0 * M_PI) / (after - before);
+		}
+
+		/**
+		 * @brief Fastest the robot can go through a curvature changing at a rate, without the acceleration limits
+		 */
+		double getCurvatureSpeedLimit(double curvature, double curvatureChange) const {
+			double halfTrackWidth = 0.5 * constraints.trackWidth.getValue();
+			double maxSpeed = constraints.maxSpeed.getValue();
+			double maxWheelSpeed = constraints.maxWheelSpeed.getValue() > 0.0 ? constraints.maxWheelSpeed.getValue() : maxSpeed;
+			double maxWheelAcceleration = constraints.maxWheelAcceleration.getValue() > 0.0 ? constraints.maxWheelAcceleration.getValue() : constraints.maxAcceleration.getValue();
+			double maxLateralAcceleration = constraints.maxLateralAcceleration.getValue();
+
+			double speedLimit = std::min(maxSpeed, maxWheelSpeed / (1.0 + fabs(curvature) * halfTrackWidth));
+
+			if (curvatureChange > 0.0) {
+				speedLimit = std::min(speedLimit, sqrt(maxWheelAcceleration / (curvatureChange * halfTrackWidth)));
+			}
+
+			if (maxLateralAcceleration > 0.0 && curvature != 0.0) {
+				speedLimit = std::min(speedLimit, sqrt(maxLateralAcceleration / fabs(curvature)));
+			}
+
+			// A sharp corner can bring the limit close to zero, it is given the smallest spacing
+			return std::isfinite(speedLimit) ? std::max(speedLimit, 1.0e-3) : 1.0e-3;
+		}
+
+		/**
+		 * @brief Distances along the path in meters to sample at, increasing from 0 to the length of the path, with the
+		 * curvature at each of them and in the middle of the interval after each, NaN where it hasn't been worked out
+		 *
+		 * Over an interval the curvature changes by the larger of its changes over the two halves, the same as over the
+		 * steps either side of a sample in the passes.
+		 */
+		void getSampleDistances(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const std::vector<double>& segmentStarts, std::vector<double>& distances, std::vector<double>& curvature, std::vector<double>& middleCurvature) const {
+			double length = segmentStarts.back();
+
+			if (constraints.maxTimeError.getValue() <= 0.0 || length <= 0.0) {
+				int granularity = std::max(5.0, length / constraints.sampleSpacing.getValue());
+
+				for (int i = 0; i <= granularity; i++) {
+					distances.emplace_back(length * (static_cast<double>(i) / static_cast<double>(granularity)));
+					curvature.emplace_back(getCurvatureAt(segments, inverted, segmentStarts, distances.back()));
+					middleCurvature.emplace_back(NAN);
+				}
+
+				return;
+			}
+
+			// Seconds of error allowed per metre of path
+			double errorBudget = constraints.maxTimeError.getValue() / length;
+
+			// The middle of the interval before a sample is only kept when that interval ends at the sample
+			double lastEnd = NAN;
+
+			auto addSample = [&](double distance, double sampleCurvature, double end, double middle) {
+				if (!distances.empty() && distance != lastEnd) {
+					middleCurvature.back() = NAN;
+				}
+
+				distances.emplace_back(distance);
+				curvature.emplace_back(sampleCurvature);
+				middleCurvature.emplace_back(middle);
+				lastEnd = end;
+			};
+
+			std::vector<std::array<double, 4>> intervals;
+
+			for (size_t segment = 0; segment < segments.size(); segment++) {
+				double segmentStart = segmentStarts[segment];
+				double segmentLength = segmentStarts[segment + 1] - segmentStart;
+
+				// The robot stops at a change of direction one inch before the joint, the same as with even samples
+				if (segment > 0 && segment < inverted.size() && inverted.at(segment) != inverted.at(segment - 1) && segmentStart - inch.getValue() > distances.back()) {
+					double reverse = segmentStart - inch.getValue();
+					addSample(reverse, getCurvatureAt(segments, inverted, segmentStarts, reverse), NAN, NAN);
+				}
+
+				int count = std::max(1.0, ceil(segmentLength / maxSpacing));
+				double endCurvature = getCurvatureAt(segments, inverted, segmentStarts, segmentStarts[segment + 1]);
+
+				for (int i = count - 1; i >= 0; i--) {
+					double start = segmentStart + segmentLength * i / count;
+					double end = segmentStart + segmentLength * (i + 1) / count;
+					double startCurvature = getCurvatureAt(segments, inverted, segmentStarts, start);
+
+					intervals.push_back({start, end, startCurvature, endCurvature});
+					endCurvature = startCurvature;
+				}
+
+				// Split intervals until each is within its share of the error, left halves first so the distances come
+				// out in order
+				while (!intervals.empty()) {
+					auto [start, end, startCurvature, endCurvature] = intervals.back();
+					intervals.pop_back();
+
+					double span = end - start;
+					double middle = start + span * 0.5;
+					double curvatureAtMiddle = getCurvatureAt(segments, inverted, segmentStarts, middle);
+					double curvatureChange = std::max(fabs(curvatureAtMiddle - startCurvature), fabs(endCurvature - curvatureAtMiddle)) / (span * 0.5);
+
+					double startLimit = getCurvatureSpeedLimit(startCurvature, curvatureChange);
+					double middleLimit = getCurvatureSpeedLimit(curvatureAtMiddle, curvatureChange);
+					double endLimit = getCurvatureSpeedLimit(endCurvature, curvatureChange);
+
+					double linearTime = 2.0 * span / (startLimit + endLimit);
+					double simpsonTime = span / 6.0 * (1.0 / startLimit + 4.0 / middleLimit + 1.0 / endLimit);
+
+					if (fabs(linearTime - simpsonTime) > errorBudget * span && span * 0.5 >= minSpacing) {
+						intervals.push_back({middle, end, curvatureAtMiddle, endCurvature});
+						intervals.push_back({start, middle, startCurvature, curvatureAtMiddle});
+					} else if (distances.empty() || start > distances.back()) {
+						addSample(start, startCurvature, end, curvatureAtMiddle);
+					}
+				}
+			}
+
+			addSample(length, getCurvatureAt(segments, inverted, segmentStarts, length), NAN, NAN);
+		}
+
+		/**
+		 * @brief Fastest speed at a sample coming from a neighbouring sample distanceChange away at lastSpeed
+		 *
+		 * Each wheel goes r = (1 +- k * trackWidth/2) times as fast as the center, and over the step it accelerates at
+		 * (r * v - lastR * lastSpeed) * (v + lastSpeed) / (2 * ds), the same way the wheel accelerations of the result
+		 * are worked out. Past the speed where the wheel keeps its speed both factors only go up with v, so the fastest
+		 * v is where it reaches the limit, a quadratic in v. With the friction circle the acceleration over the step is
+		 * the mean of what the turn leaves at its two ends, sqrt(lateral^2 - (v^2 * k)^2) at each, and the speed v is
+		 * also the largest with v^2 <= lastSpeed^2 + 2 * ds * that mean. Taking only the end's puts every step of a long
+		 * turn off the same way, which adds up to more than the error of any one interval shows. The right side only
+		 * goes down as v goes up so it is found by bisection on v^2.
+		 *
+		 * @param lastCurvature Curvature at the neighbouring sample
+		 */
+		double getReachableSpeed(double lastSpeed, double distanceChange, double curvature, double lastCurvature, double speedLimit) const {
+			double halfTrackWidth = 0.5 * constraints.trackWidth.getValue();
+			double maxAcceleration = constraints.maxAcceleration.getValue();
+			double maxWheelAcceleration = constraints.maxWheelAcceleration.getValue() > 0.0 ? constraints.maxWheelAcceleration.getValue() : maxAcceleration;
+			double maxLateralAcceleration = constraints.maxLateralAcceleration.getValue();
+
+			lastSpeed = fabs(lastSpeed);
+
+			double lastSquaredSpeed = lastSpeed * lastSpeed;
+			double squaredSpeed = std::min(lastSquaredSpeed + 2.0 * maxAcceleration * distanceChange, speedLimit * speedLimit);
+
+			// |r * v - lastWheelSpeed| * (v + lastSpeed) <= 2 * ds * maxWheelAcceleration for both wheels
+			double bound = 2.0 * distanceChange * maxWheelAcceleration;
+
+			for (double side : {-1.0, 1.0}) {
+				double wheelRatio = 1.0 + side * curvature * halfTrackWidth;
+				double lastWheelSpeed = (1.0 + side * lastCurvature * halfTrackWidth) * lastSpeed;
+				double wheelLimit;
+
+				if (fabs(wheelRatio) > 1.0e-9) {
+					double matchedSpeed = lastWheelSpeed / wheelRatio;
+					wheelLimit = 0.5 * (matchedSpeed - lastSpeed + sqrt((matchedSpeed + lastSpeed) * (matchedSpeed + lastSpeed) + 4.0 * bound / fabs(wheelRatio)));
+				} else {
+					// The wheel stops here whatever the speed
+					wheelLimit = lastWheelSpeed != 0.0 ? bound / fabs(lastWheelSpeed) - lastSpeed : INFINITY;
+				}
+
+				wheelLimit = std::max(0.0, wheelLimit);
+				squaredSpeed = std::min(squaredSpeed, wheelLimit * wheelLimit);
+			}
+
+			if (constraints.frictionCircle && maxLateralAcceleration > 0.0 && squaredSpeed > lastSquaredSpeed) {
+				// Acceleration the turn leaves at a squared speed
+				auto getFreeAcceleration = [&](double squaredSpeed, double turnCurvature) {
+					double lateralAcceleration = std::min(maxLateralAcceleration, squaredSpeed * fabs(turnCurvature));
+
+					return sqrt(maxLateralAcceleration * maxLateralAcceleration - lateralAcceleration * lateralAcceleration);
+				};
+
+				double lastFreeAcceleration = getFreeAcceleration(lastSquaredSpeed, lastCurvature);
+
+				// Squared speed reachable at the end of the step
+				auto getReachable = [&](double squaredSpeed) {
+					return lastSquaredSpeed + distanceChange * (lastFreeAcceleration + getFreeAcceleration(squaredSpeed, curvature));
+				};
+
+				if (getReachable(squaredSpeed) < squaredSpeed) {
+					// Standing at lastSpeed is always reachable, the low end stays reachable and the high end doesn't
+					double low = lastSquaredSpeed;
+					double high = squaredSpeed;
+
+					for (int i = 0; i < frictionCircleIterations; i++) {
+						double middle = 0.5 * (low + high);
+
+						if (getReachable(middle) >= middle) {
+							low = middle;
+						} else {
+							high = middle;
+						}
+					}
+
+					squaredSpeed = low;
+				}
+			}
+
+			return sqrt(std::max(0.0, squaredSpeed));
+		}
+
+		/**
+		 * @brief Speeds from ReachabilitySolver, the limits at each sample written as linear limits on the acceleration
+		 * to the next sample and the squared speed
+		 *
+		 * Over the step from x to the next squared speed x + 2 u ds each wheel accelerates at
+		 * r' * u + dr/ds * (x + v * v') / 2, worked out the same way as the wheel accelerations of the result, with
+		 * r' = 1 +- k' * trackWidth/2 at the next sample and dr the change in r over the step. v * v' is at most
+		 * the mean of the two squared speeds and at least the smaller of them, so keeping the wheel within its limit at
+		 * those ends keeps it within the limit for the real one. The friction circle a^2 + (v^2 * k)^2 <= lateral^2 isn't
+		 * linear, it is replaced by a polygon inside it and held with the mean lateral acceleration of the step, the
+		 * same as the two passes. The forward speeds go into limitedSpeedLeft and limitedSpeed, and the fastest speeds
+		 * the robot can still stop from go into limitedSpeedRight.
+		 */
+		void solveReachability(const std::vector<double>& distances, const std::vector<double>& curvature, const std::vector<double>& direction, const std::vector<double>& speedLimit, PlannedPath& result) const {
+			double halfTrackWidth = 0.5 * constraints.trackWidth.getValue();
+			double maxAcceleration = constraints.maxAcceleration.getValue();
+			double maxWheelAcceleration = constraints.maxWheelAcceleration.getValue() > 0.0 ? constraints.maxWheelAcceleration.getValue() : maxAcceleration;
+			double maxLateralAcceleration = constraints.maxLateralAcceleration.getValue();
+			bool frictionCircle = constraints.frictionCircle && maxLateralAcceleration > 0.0;
+
+			ReachabilitySolver solver;
+			solver.reserve(distances.size(), 2 + 6 + (frictionCircle ? frictionCircleEdges : 0));
+
+			// Limits on the friction circle over the step from sample i, the lateral acceleration the mean of
+			// x * |k| at the start and (x + 2 u ds) * |k'| at the end
+			auto addFrictionCircle = [&](size_t i, double distanceChange) {
+				// Edges of a polygon with its corners on the half circle, a * cos(angle) + v^2 * |k| * sin(angle)
+				for (int edge = 0; edge < frictionCircleEdges; edge++) {
+					double angle = (edge + 0.5) * M_PI / frictionCircleEdges;
+					double startLateral = sin(angle) * fabs(curvature[i]);
+					double endLateral = sin(angle) * fabs(curvature[i + 1]);
+
+					solver.addConstraint(cos(angle) + distanceChange * endLateral, 0.5 * (startLateral + endLateral), maxLateralAcceleration * cos(0.5 * M_PI / frictionCircleEdges));
+				}
+			};
+
+			for (size_t i = 0; i < distances.size(); i++) {
+				solver.addStage(speedLimit[i] * speedLimit[i]);
+
+				solver.addConstraint(1.0, 0.0, maxAcceleration);
+				solver.addConstraint(-1.0, 0.0, maxAcceleration);
+
+				if (i + 1 >= distances.size()) {
+					continue;
+				}
+
+				double distanceChange = distances[i + 1] - distances[i];
+
+				if (frictionCircle) {
+					addFrictionCircle(i, distanceChange);
+				}
+
+				// Samples on top of each other share a speed, the wheels don't accelerate between them
+				if (distanceChange <= 0.0) {
+					continue;
+				}
+
+				for (double side : {-1.0, 1.0}) {
+					double wheelRatio = 1.0 + side * curvature[i + 1] * halfTrackWidth;
+					double wheelRatioChange = side * (curvature[i + 1] - curvature[i]) * halfTrackWidth;
+					double wheelSlope = wheelRatioChange / distanceChange;
+
+					// v * v' is at most the mean of the squared speeds, x + u ds in its place, and at least the smaller of
+					// them, x or x + 2 u ds. Whichever the wheel's limit from above or below depends on the sign of dr.
+					double sign = wheelRatioChange >= 0.0 ? 1.0 : -1.0;
+
+					solver.addConstraint(sign * (wheelRatio + 0.5 * wheelRatioChange), sign * wheelSlope, maxWheelAcceleration);
+
+					for (double acceleration : {wheelRatio, wheelRatio + 2.0 * wheelRatioChange}) {
+						solver.addConstraint(-sign * acceleration, -sign * wheelSlope, maxWheelAcceleration);
+					}
+				}
+			}
+
+			std::vector<double> squaredSpeeds = solver.solve(distances);
+
+			for (size_t i = 0; i < distances.size(); i++) {
+				QSpeed speed = direction[i] * sqrt(squaredSpeeds[i]);
+
+				result.limitedSpeedLeft.set(i, speed);
+				result.limitedSpeedRight.set(i, QSpeed(direction[i] * sqrt(solver.getControllableMax(i))));
+				result.limitedSpeed.set(i, speed);
+			}
+		}
+
+		/**
+		 * @brief Position and heading of the robot at every sample of a planned path
+		 */
+		static void samplePositions(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const std::vector<double>& segmentStarts, const std::vector<double>& distances, PlannedPath& result) {
+			int t = 0;
+
+			for (int i = 0; i < (int) distances.size(); i++) {
+				while (t < (int) segments.size() - 1 && distances[i] >= segmentStarts[t + 1]) {
+					t++;
+				}
+
+				double remainder = segments.at(t).getTByLength((distances[i] - segmentStarts[t]) * metre);
+
+				Vec2 position = segments.at(t).getPosition(remainder);
+				result.positionX.set(i, position.x * metre);
+				result.positionY.set(i, position.y * metre);
+				result.heading.set(i, segments.at(t).getAngle(remainder) + (inverted.at(t) ? 180_deg : 0_deg));
+			}
+		}
+
+		/**
+		 * @brief Run the passes with samples at distances, curvature has the curvature at each of them. Everything but
+		 * the positions and headings is filled in.
+		 */
+		PlannedPath plan(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const std::vector<double>& segmentStarts, const std::vector<double>& distances, const std::vector<double>& curvature) const {
+			PlannedPath result;
+			result.length = segmentStarts.back();
+
+			int samples = distances.size();
+			int granularity = samples - 1;
+			result.granularity = granularity;
+
+			result.curvatureByDistance.resize(samples);
+			result.maxSpeedByDistance.resize(samples);
+			result.limitedSpeedLeft.resize(samples);
+			result.limitedSpeedRight.resize(samples);
+			result.limitedSpeed.resize(samples);
+			result.time.resize(samples);
+			result.distanceTotal.resize(samples);
+			result.accelerationByDistance.resize(samples);
+			result.positionX.resize(samples);
+			result.positionY.resize(samples);
+			result.heading.resize(samples);
+			result.leftWheelSpeed.resize(samples);
+			result.rightWheelSpeed.resize(samples);
+			result.leftWheelAcceleration.resize(samples);
+			result.rightWheelAcceleration.resize(samples);
+			result.lateralAcceleration.resize(samples);
+
+			// Everything below is in SI units, the result converts to its own units as it is stored
+			double halfTrackWidth = 0.5 * constraints.trackWidth.getValue();
+			double maxSpeed = constraints.maxSpeed.getValue();
+			double maxAcceleration = constraints.maxAcceleration.getValue();
+			double maxWheelSpeed = constraints.maxWheelSpeed.getValue() > 0.0 ? constraints.maxWheelSpeed.getValue() : maxSpeed;
+			double maxWheelAcceleration = constraints.maxWheelAcceleration.getValue() > 0.0 ? constraints.maxWheelAcceleration.getValue() : maxAcceleration;
+			double maxLateralAcceleration = constraints.maxLateralAcceleration.getValue();
+
+			std::vector<double> direction(samples);
+			std::vector<double> speedLimit(samples);
+
+			// Distance only goes up so the segment is found by walking forwards from the last one
+			int t = 0;
+
+			for (int i = 0; i < samples; i++) {
+				result.distanceTotal.set(i, QLength(distances[i]));
+
+				while (t < (int) segments.size() - 1 && distances[i] >= segmentStarts[t + 1]) {
+					t++;
+				}
+
+				direction[i] = inverted.at(t) ? -1.0 : 1.0;
+			}
+
+			std::vector<double> wheelRatio(samples);
+			std::vector<double> curvatureSlope(samples);
+			std::vector<double> curvatureChange(samples);
+
+			// Change in curvature per metre over the step to each sample, the same step its wheel acceleration is
+			// worked out over
+			for (int i = 1; i < samples; i++) {
+				double distanceChange = distances[i] - distances[i - 1];
+				curvatureSlope[i] = distanceChange > 0.0 ? (curvature[i] - curvature[i - 1]) / distanceChange : 0.0;
+			}
+
+			// The outer wheel goes (1 + |k| * trackWidth/2) times as fast as the center, and when the curvature changes
+			// the wheels also have to speed up and slow down against each other by v^2 * |dk/ds| * trackWidth/2 on the
+			// steps either side
+			for (int i = 0; i < samples; i++) {
+				wheelRatio[i] = 1.0 + fabs(curvature[i]) * halfTrackWidth;
+				curvatureChange[i] = std::max(fabs(curvatureSlope[i]), i + 1 < samples ? fabs(curvatureSlope[i + 1]) : 0.0) * halfTrackWidth;
+
+				// Faster than this the wheels can only keep within their limit through the curvature change by the robot
+				// slowing down, and going faster into it only leaves the robot slower coming out
+				speedLimit[i] = std::min(maxSpeed, maxWheelSpeed / wheelRatio[i]);
+				if (curvatureChange[i] > 0.0) {
+					speedLimit[i] = std::min(speedLimit[i], sqrt(maxWheelAcceleration / curvatureChange[i]));
+				}
+
+				// v^2 * |k| can't go past the lateral limit
+				if (maxLateralAcceleration > 0.0 && curvature[i] != 0.0) {
+					speedLimit[i] = std::min(speedLimit[i], sqrt(maxLateralAcceleration / fabs(curvature[i])));
+				}
+
+				result.maxSpeedByDistance.set(i, QSpeed(direction[i] * speedLimit[i]));
+				result.curvatureByDistance.set(i, QCurvature(curvature[i]));
+			}
+
+			// The wheels can't flip direction instantly, so the robot has to stop where the path changes direction
+			for (int i = 1; i < samples; i++) {
+				if (direction[i] != direction[i - 1]) {
+					speedLimit[i - 1] = 0.0;
+				}
+			}
+
+			if (constraints.method == PlannerMethod::Reachability) {
+				solveReachability(distances, curvature, direction, speedLimit, result);
+			} else {
+				auto getReachableSpeed = [&](int i, int last, double lastSpeed) {
+					return VelocityPlanner::getReachableSpeed(lastSpeed, fabs(distances[i] - distances[last]), curvature[i], curvature[last], speedLimit[i]) * direction[i];
+				};
+
+				double lastSpeed = 0.0;
+
+				for (int i = 0; i < samples; i++) {
+					if (i != 0) {
+						lastSpeed = getReachableSpeed(i, i - 1, lastSpeed);
+					}
+
+					result.limitedSpeedLeft.set(i, QSpeed(lastSpeed));
+				}
+
+				lastSpeed = 0.0;
+
+				for (int i = granularity; i >= 0; i--) {
+					if (i != granularity) {
+						lastSpeed = getReachableSpeed(i, i + 1, lastSpeed);
+					}
+
+					result.limitedSpeedRight.set(i, QSpeed(lastSpeed));
+				}
+
+				// Speeds are negative on inverted segments, so the slower of the passes is the one closer to zero
+				for (int i = 0; i < samples; i++) {
+					QSpeed left = result.limitedSpeedLeft[i];
+					QSpeed right = result.limitedSpeedRight[i];
+
+					result.limitedSpeed.set(i, fabs(right.getValue()) < fabs(left.getValue()) ? right : left);
+				}
+			}
+
+			// Positive curvature turns the heading clockwise, a right turn with the left wheel on the outside. Driving
+			// backwards flips which way the robot turns for the same curve. Curvature is radians per metre, the radians
+			// drop out of the turn and of v^2 * k.
+			QuantityArray<Number> turn(Number(1.0), samples);
+			QuantityArray<decltype(Number() / QLength())> turnCurvature(Number(1.0) / metre, samples);
+
+			for (int i = 0; i < samples; i++) {
+				turn.set(i, curvature[i] * direction[i] * halfTrackWidth);
+				turnCurvature.set(i, curvature[i] * direction[i] / metre);
+			}
+
+			// How much faster the outside wheel is than the robot and the inside wheel slower
+			QuantityArray<QSpeed> turnSpeed = result.limitedSpeed * turn;
+
+			result.leftWheelSpeed = result.limitedSpeed + turnSpeed;
+			result.rightWheelSpeed = result.limitedSpeed - turnSpeed;
+			result.lateralAcceleration = (result.limitedSpeed * result.limitedSpeed * turnCurvature).to(inch/second/second);
+
+			double lastTime = 0.0;
+
+			for (int i = 1; i < samples; i++) {
+				double speed = result.limitedSpeed[i].getValue();
+				double previousSpeed = result.limitedSpeed[i - 1].getValue();
+				double distanceChange = distances[i] - distances[i - 1];
+				QTime timeChange = getDuration(previousSpeed, speed, distanceChange);
+
+				lastTime += timeChange.getValue();
+				result.time.set(i, QTime(lastTime));
+				result.accelerationByDistance.set(i, QAcceleration((speed * speed - previousSpeed * previousSpeed) / (2.0 * distanceChange)));
+
+				if (timeChange.getValue() > 0.0) {
+					result.leftWheelAcceleration.set(i, (result.leftWheelSpeed[i] - result.leftWheelSpeed[i - 1]) / timeChange);
+					result.rightWheelAcceleration.set(i, (result.rightWheelSpeed[i] - result.rightWheelSpeed[i - 1]) / timeChange);
+				}
+			}
+
+			result.duration = lastTime;
+
+			return result;
+		}
+
+		/**
+		 * @brief Split every interval where the passes between its ends are off by more than the interval's share of
+		 * maxTimeError, along with the curvature at the new samples
+		 *
+		 * The speed in the middle is worked out from both ends with the limits in the middle, and the time over the
+		 * interval in two halves is compared with the time over it in one piece. The halves are checked the same way
+		 * with the speed in the middle, so an interval can be split more than once before the passes run again.
+		 *
+		 * @return Whether the errors of the intervals add up to within maxTimeError, intervals already minSpacing apart
+		 * aren't split even when they are off by more than their share
+		 */
+		bool refineDistances(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted, const std::vector<double>& segmentStarts, std::vector<double>& distances, std::vector<double>& curvature, std::vector<double>& middleCurvature, const PlannedPath& path) const {
+			// Seconds of error allowed per metre of path
+			double errorBudget = constraints.maxTimeError.getValue() / segmentStarts.back();
+			double totalError = 0.0;
+
+			std::vector<double> refined;
+			std::vector<double> refinedCurvature;
+			std::vector<double> refinedMiddleCurvature;
+			refined.reserve(distances.size());
+			refinedCurvature.reserve(distances.size());
+			refinedMiddleCurvature.reserve(distances.size());
+
+			auto addSample = [&](double distance, double sampleCurvature, double middle) {
+				refined.emplace_back(distance);
+				refinedCurvature.emplace_back(sampleCurvature);
+				refinedMiddleCurvature.emplace_back(middle);
+			};
+
+			std::vector<std::array<double, 7>> intervals;
+
+			for (size_t i = 0; i + 1 < distances.size(); i++) {
+				intervals.push_back({distances[i], distances[i + 1], fabs(path.limitedSpeed[i].getValue()), fabs(path.limitedSpeed[i + 1].getValue()), curvature[i], curvature[i + 1], middleCurvature[i]});
+
+				// Left halves first so the distances come out in order
+				while (!intervals.empty()) {
+					auto [start, end, startSpeed, endSpeed, startCurvature, endCurvature, curvatureAtMiddle] = intervals.back();
+					intervals.pop_back();
+
+					double span = end - start;
+					double middle = start + span * 0.5;
+
+					// Samples on top of each other where the robot changes direction
+					if (span <= 0.0) {
+						addSample(start, startCurvature, NAN);
+						continue;
+					}
+
+					if (std::isnan(curvatureAtMiddle)) {
+						curvatureAtMiddle = getCurvatureAt(segments, inverted, segmentStarts, middle);
+					}
+
+					double curvatureChange = std::max(fabs(curvatureAtMiddle - startCurvature), fabs(endCurvature - curvatureAtMiddle)) / (span * 0.5);
+					double speedLimit = getCurvatureSpeedLimit(curvatureAtMiddle, curvatureChange);
+
+					double middleSpeed = std::min({speedLimit,
+												   getReachableSpeed(startSpeed, span * 0.5, curvatureAtMiddle, startCurvature, speedLimit),
+												   getReachableSpeed(endSpeed, span * 0.5, curvatureAtMiddle, endCurvature, speedLimit)});
+
+					double error = fabs(getDuration(startSpeed, middleSpeed, span * 0.5) + getDuration(middleSpeed, endSpeed, span * 0.5) - getDuration(startSpeed, endSpeed, span));
+
+					if (error <= errorBudget * span || span * 0.5 < minSpacing) {
+						addSample(start, startCurvature, curvatureAtMiddle);
+						totalError += error;
+					} else {
+						intervals.push_back({middle, end, middleSpeed, endSpeed, curvatureAtMiddle, endCurvature, NAN});
+						intervals.push_back({start, middle, startSpeed, middleSpeed, startCurvature, curvatureAtMiddle, NAN});
+					}
+				}
+			}
+
+			addSample(distances.back(), curvature.back(), NAN);
+
+			distances = std::move(refined);
+			curvature = std::move(refinedCurvature);
+			middleCurvature = std::move(refinedMiddleCurvature);
+
+			return totalError <= constraints.maxTimeError.getValue();
+		}
+
+	public:
+		explicit VelocityPlanner(PlannerConstraints constraints) : constraints(constraints) {}
+
+		/**
+		 * @brief Run the forward and backward passes over the path
+		 *
+		 * @param segments The segments of the path, in order
+		 * @param inverted Whether the robot drives each segment backwards
+		 * @return PlannedPath The sampled speeds, curvatures and times
+		 */
+		PlannedPath calculate(std::vector<BezierSegment>& segments, const std::vector<bool>& inverted) {
+			std::vector<double> segmentStarts = {0.0};
+
+			for (auto &segment : segments) {
+				segmentStarts.emplace_back(segmentStarts.back() + segment.getDistance().getValue());
+			}
+
+			std::vector<double> distances;
+			std::vector<double> curvature;
+			std::vector<double> middleCurvature;
+
+			getSampleDistances(segments, inverted, segmentStarts, distances, curvature, middleCurvature);
+			PlannedPath result = plan(segments, inverted, segmentStarts, distances, curvature);
+
+			// Adaptive samples are placed by the speed limit from curvature, the acceleration limits also change along
+			// the path so the planned speeds are checked between samples and the passes run again with more samples
+			// where they are off by more than their share of the error. Intervals stop being split at minSpacing, so
+			// this ends.
+			bool withinTimeError = true;
+
+			while (constraints.maxTimeError.getValue() > 0.0) {
+				size_t samples = distances.size();
+				withinTimeError = refineDistances(segments, inverted, segmentStarts, distances, curvature, middleCurvature, result);
+
+				if (distances.size() == samples) {
+					break;
+				}
+
+				result = plan(segments, inverted, segmentStarts, distances, curvature);
+			}
+
+			result.withinTimeError = withinTimeError;
+			samplePositions(segments, inverted, segmentStarts, distances, result);
+
+			return result;
+		}
+
+		PlannerConstraints getConstraints() const {
+			return constraints;
+		}
+
+		void setConstraints(PlannerConstraints constraints) {
+			this->constraints = constraints;
+		}
+	};
+} // namespace PathPlanner